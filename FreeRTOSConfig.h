@@ -100,6 +100,12 @@
 #define configIDLE_SHOULD_YIELD		1
 #define configUSE_MUTEXES		1
 #define configCHECK_FOR_STACK_OVERFLOW	1
+#ifndef configUSE_QUEUE_LOANS	/* pvQueueReserve()/pvQueueBorrow(), queue.h */
+#define configUSE_QUEUE_LOANS		0	/* Unused by the application; bench_cola sets it */
+#endif
+#ifndef configQUEUE_SMALL_ITEM_COPY	/* -DconfigQUEUE_SMALL_ITEM_COPY=0 to compare */
+#define configQUEUE_SMALL_ITEM_COPY	1	/* 2/4/8-byte items without memcpy() calls, queue.c */
+#endif
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
@@ -109,7 +115,13 @@
 to exclude the API function. */
 
 #define INCLUDE_vTaskPrioritySet	0
+#ifndef INCLUDE_uxTaskPriorityGet	/* Only banco_mutex.c uses it */
+#if BANCO_MUTEX
+#define INCLUDE_uxTaskPriorityGet	1
+#else
 #define INCLUDE_uxTaskPriorityGet	0
+#endif
+#endif
 #define INCLUDE_vTaskDelete		0
 #define INCLUDE_vTaskCleanUpResources	0
 #define INCLUDE_vTaskSuspend		0
@@ -129,4 +141,119 @@ configKERNEL_INTERRUPT_PRIORITY setting.  Here 15 corresponds to the lowest
 NVIC value of 255. */
 #define configLIBRARY_KERNEL_INTERRUPT_PRIORITY	15
 
+/*-----------------------------------------------------------
+ * Static allocation only: make MEMORIA_ESTATICA=1
+ *
+ * TCBs and stacks live in .bss (TAREA_CREAR() in app_tasks.h, idle task
+ * memory in app_tasks.c), so creating them cannot fail at run time and
+ * heap_4.c, with its configTOTAL_HEAP_SIZE arena, is not linked at all.
+ *----------------------------------------------------------*/
+#ifndef MEMORIA_ESTATICA
+#define MEMORIA_ESTATICA	0
+#endif
+
+#if MEMORIA_ESTATICA
+#define configSUPPORT_STATIC_ALLOCATION		1
+#define configSUPPORT_DYNAMIC_ALLOCATION	0
+#endif
+
+/*-----------------------------------------------------------
+ * Per-task CPU statistics (rtstats.h): make RTSTATS=1
+ *
+ * Accounted on every context switch from the DWT cycle counter (the TSC
+ * on the host).  Tasks are told apart by uxTCBNumber, which needs the
+ * trace facility.  configGENERATE_RUN_TIME_STATS stays off so the switch
+ * is not timed twice.
+ *----------------------------------------------------------*/
+#ifndef RTSTATS
+#define RTSTATS		0
+#endif
+
+#if RTSTATS
+#include "rtstats.h"
+#define rtstatsSWITCHED_IN()		rtstats_switch_in( ( unsigned ) pxCurrentTCB->uxTCBNumber )
+#define rtstatsTASK_CREATE( pxTCB )	rtstats_creada( ( pxTCB ), ( unsigned ) ( pxTCB )->uxTCBNumber )
+#else
+#define rtstatsSWITCHED_IN()
+#define rtstatsTASK_CREATE( pxTCB )
+#endif
+
+/*-----------------------------------------------------------
+ * Scheduler event trace into a RAM ring buffer (traza.h): make TRAZA=1
+ *
+ * Every hook below runs with kernel interrupts masked, so recording is
+ * a plain store of 8 bytes, except DELAY and DELAY_UNTIL: those run with
+ * only the scheduler suspended, where SysTick or a FromISR call can
+ * record in the middle, so they mask interrupts themselves
+ * (trazaEVENTO_TAREA).  SWITCHED_OUT also records whether the task is
+ * still in its ready list (pre-empted) or is about to block.
+ *----------------------------------------------------------*/
+#ifndef TRAZA
+#define TRAZA		0
+#endif
+
+#if TRAZA
+#include "traza.h"
+#define trazaEVENTO_TAREA( ev )		do { UBaseType_t uxTrazaMascara = portSET_INTERRUPT_MASK_FROM_ISR(); \
+		traza_evento( ( ev ), 0, 0 ); portCLEAR_INTERRUPT_MASK_FROM_ISR( uxTrazaMascara ); } while( 0 )
+#define trazaSWITCHED_IN()		traza_evento( TRAZA_ENTRA, pxCurrentTCB->uxTCBNumber, 0 )
+#define trazaTASK_CREATE( pxTCB )	traza_creada( ( pxTCB ), ( unsigned ) ( pxTCB )->uxTCBNumber )
+#define traceTASK_SWITCHED_OUT()	traza_evento( TRAZA_SALE, pxCurrentTCB->uxTCBNumber, \
+		( uint32_t ) listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ), \
+						     &( pxCurrentTCB->xStateListItem ) ) )
+#define traceTASK_INCREMENT_TICK( xTickCount )	traza_evento( TRAZA_TICK, 0, ( uint16_t ) ( xTickCount ) )
+#define traceQUEUE_SEND( pxQueue )	traza_evento( TRAZA_COLA_ENVIO, 0, ( uint16_t ) ( uintptr_t ) ( pxQueue ) )
+#define traceQUEUE_RECEIVE( pxQueue )	traza_evento( TRAZA_COLA_RECEPCION, 0, ( uint16_t ) ( uintptr_t ) ( pxQueue ) )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )	traza_evento( TRAZA_COLA_BLOQUEO, 0, ( uint16_t ) ( uintptr_t ) ( pxQueue ) )
+#define traceTASK_NOTIFY_GIVE_FROM_ISR()	traza_evento( TRAZA_NOTIF_ISR, 0, pxTCB->uxTCBNumber )
+#define traceTASK_NOTIFY_TAKE_BLOCK()	traza_evento( TRAZA_NOTIF_BLOQUEO, 0, 0 )
+#define traceTASK_NOTIFY_TAKE()		traza_evento( TRAZA_NOTIF_TOMA, 0, 0 )
+#define traceTASK_DELAY()		trazaEVENTO_TAREA( TRAZA_ESPERA )
+#define traceTASK_DELAY_UNTIL( xTimeToWake )	trazaEVENTO_TAREA( TRAZA_ESPERA )
+#else
+#define trazaSWITCHED_IN()
+#define trazaTASK_CREATE( pxTCB )
+#endif
+
+/*-----------------------------------------------------------
+ * Stack and heap low-water-mark monitor task (monitor.h): make MONITOR=1
+ *
+ * Finds each task's stack through vTaskGetInfo(), which needs the trace
+ * facility (that also keeps the 0xa5 stack fill it measures).
+ *----------------------------------------------------------*/
+#ifndef MONITOR
+#define MONITOR		0
+#endif
+
+#if MONITOR
+#include "monitor.h"
+#define monitorTASK_CREATE( pxTCB )	monitor_creada( ( pxTCB ), ( unsigned ) ( pxTCB )->uxTCBNumber )
+#else
+#define monitorTASK_CREATE( pxTCB )
+#endif
+
+#if RTSTATS || TRAZA || MONITOR
+#undef configUSE_TRACE_FACILITY
+#define configUSE_TRACE_FACILITY	1
+#define traceTASK_SWITCHED_IN()		do { rtstatsSWITCHED_IN(); trazaSWITCHED_IN(); } while( 0 )
+#define traceTASK_CREATE( pxNewTCB )	do { rtstatsTASK_CREATE( pxNewTCB ); trazaTASK_CREATE( pxNewTCB ); \
+						     monitorTASK_CREATE( pxNewTCB ); } while( 0 )
+#endif
+
+/*-----------------------------------------------------------
+ * Host (Linux) simulation build: make -f Makefile.host
+ *
+ * The port (rtos/port_host.c) generates the virtual tick from the idle
+ * hook, and the host harness steps the simulated peripherals from the
+ * tick hook.
+ *----------------------------------------------------------*/
+#ifdef HOST_PORT
+#undef configUSE_IDLE_HOOK
+#define configUSE_IDLE_HOOK		1
+#undef configUSE_TICK_HOOK
+#define configUSE_TICK_HOOK		1
+#define configASSERT( x )		if( ( x ) == 0 ) vPortHostAssert( __FILE__, __LINE__ )
+#include "rtos/portmacro_host.h"
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
@@ -1,28 +1,81 @@
 #include "FreeRTOS.h"
 #include "task.h"
-#include "semphr.h"     // <-- AÑADIDO (para Mutex y secciones críticas)
-
-#include <libopencm3/stm32/gpio.h>
-#include <libopencm3/stm32/timer.h>
 
 #include "app_tasks.h"
+#include "control.h"
+#include "dds.h"
+#include "hal.h"
+#include "mavg.h"
+#include "pid.h"
+#include "seqlatch.h"
 
 /* ========= Búferes y Estado del Módulo ADC ========= */
 
 /*
- * Búfer de destino del DMA.
- * Es global (no estático) para que config.c pueda verlo
- * usando 'extern'. El hardware DMA escribe aquí.
+ * Totales acumulados de todas las conversiones (ver adc_get_totals).
+ * Escritor: ISR del DMA (hal_adc_block_ready). Lectores: tareas.
+ */
+static struct adc_totals adc_totals;
+static struct seqlatch totals_latch;
+static struct adc_totals totals_published[2];
+
+/* Filtros de media móvil (sólo los usa vTaskReadAnalog) */
+MAVG_DEFINE(amp_filter, FILTRO_AMP_LOG2);
+MAVG_DEFINE(freq_filter, FILTRO_FREQ_LOG2);
+
+/* Handles de las tareas (los rellena main.c al crearlas) */
+TaskHandle_t xTaskAdcHandle;
+TaskHandle_t xTaskPwmCtrlHandle;
+
+#if configSUPPORT_STATIC_ALLOCATION
+/* Memoria de la tarea IDLE (sin heap, la pide vTaskStartScheduler) */
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **pila,
+				   uint32_t *palabras)
+{
+	static StaticTask_t idle_tcb;
+	static StackType_t idle_pila[configMINIMAL_STACK_SIZE];
+
+	*tcb = &idle_tcb;
+	*pila = idle_pila;
+	*palabras = configMINIMAL_STACK_SIZE;
+}
+#endif
+
+/*
+ * Último valor filtrado publicado (ver seqlatch.h).
+ * Escritor: vTaskReadAnalog. Lectores: getters (tareas o ISRs).
+ */
+static struct seqlatch adc_latch;
+static struct adc_snapshot adc_published[2];
+
+#if HAL_PWM_DDS
+/*
+ * Generador DDS. Escritor: vTaskControlPWM (frecuencia, amplitud) y
+ * dds_set_forma_onda(). Lector: ISR del DMA1 Canal 5. Inicializado en
+ * reposo porque la ISR corre desde pwm_setup(), antes que las tareas.
  */
-volatile uint16_t adc_dma_buffer[2]; // [0]=amp, [1]=freq
+static struct dds dds = {
+	.tabla = dds_seno,
+	.medio = HAL_DDS_PERIOD / 2,
+};
 
-/* Búferes de promedio (internos a este archivo) */
-static uint16_t amp_buffer[MUESTRAS_PID];
-static uint16_t freq_buffer[MUESTRAS_PID];
-static unsigned idx_pid = 0;
+_Static_assert((uint64_t)CONTROL_ADC_FULL_SCALE * CONTROL_DDS_INC_K(HAL_DDS_FS_HZ)
+	       < (1ULL << 31), "La frecuencia máxima del DDS supera fs / 2");
+#endif
 
-/* Mutex (definido en main.c) para proteger los búferes de promedio */
-extern SemaphoreHandle_t xAdcMutex;
+#if HAL_PWM_SWEEP
+/*
+ * Barrido en curso. Escritor: barrido_iniciar() (con el DMA y su ISR
+ * parados por hal_pwm_sweep_stop()) y la ISR del DMA1 Canal 5
+ * (sweep_fill). 'barrido_en_curso' lo baja la ISR
+ * al parar el DMA.
+ */
+static struct sweep sweep;
+static volatile int barrido_en_curso;
+static unsigned mitades_tras_fin;	// Sólo la ISR (y barrido_iniciar)
+
+#define SWEEP_TIM1_HZ	72000000UL
+#endif
 
 
 /* ========= Helpers Internos (copiados de inputs_adc.c) ========= */
@@ -33,12 +86,113 @@ static inline float __u12_to_volts(uint16_t raw)
 	return (VREF_VOLTS * (float)raw) / 4095.0f;
 }
 
-static uint16_t __avg_u16(const uint16_t *buf, unsigned n)
+static inline uint16_t __abs_diff_u16(uint16_t a, uint16_t b)
+{
+	return a > b ? a - b : b - a;
+}
+
+
+/* ========= Procesamiento de Bloques (ISR del DMA) ========= */
+
+/**
+ * @brief Suma un medio búfer del DMA a los totales y los publica.
+ *
+ * Contexto de interrupción: ~2 sumas por par, sin llamadas al kernel.
+ */
+void hal_adc_block_ready(const volatile uint16_t *block, unsigned pairs)
+{
+	uint32_t amp = 0, freq = 0;
+
+	for (unsigned i = 0; i < pairs; ++i) {
+		amp  += block[2 * i];
+		freq += block[2 * i + 1];
+	}
+
+	adc_totals.amp_sum  += amp;
+	adc_totals.freq_sum += freq;
+	adc_totals.pairs    += pairs;
+	adc_totals.blocks++;
+
+	seqlatch_write_begin(&totals_latch);
+	totals_published[0] = adc_totals;
+	seqlatch_write_next(&totals_latch);
+	totals_published[1] = adc_totals;
+
+#if APP_EVENT_DRIVEN
+	/* Despierta a vTaskReadAnalog (NULL hasta que main.c la crea) */
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	if (xTaskAdcHandle != NULL)
+		vTaskNotifyGiveFromISR(xTaskAdcHandle, &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+#endif
+}
+
+
+#if HAL_PWM_DDS
+/* ========= Generador DDS (ISR del DMA1 Canal 5) ========= */
+
+/**
+ * @brief Calcula la siguiente mitad de muestras del DDS.
+ *
+ * Contexto de interrupción, sin kernel: ~7 instrucciones por muestra.
+ */
+void hal_dds_half_ready(volatile uint16_t *half, unsigned n)
+{
+	dds_fill(&dds, half, n);
+}
+
+void dds_set_forma_onda(const int16_t *tabla)
+{
+	dds_set_waveform(&dds, tabla);
+}
+#endif
+
+
+#if HAL_PWM_SWEEP
+/* ========= Barridos de frecuencia (ISR del DMA1 Canal 5) ========= */
+
+/**
+ * @brief Calcula los siguientes períodos del barrido.
+ *
+ * Contexto de interrupción, sin kernel. La mitad en la que termina el
+ * barrido acaba con la frecuencia final; cuando el DMA la ha cargado
+ * entera (segunda mitad tras el final) se para y el TIM1 se queda en ella.
+ */
+void hal_sweep_half_ready(volatile uint16_t *half, unsigned periods)
+{
+	if (sweep.terminado && barrido_en_curso && ++mitades_tras_fin == 2) {
+		hal_pwm_sweep_stop();
+		barrido_en_curso = 0;
+		return;
+	}
+	sweep_fill(&sweep, half, periods);
+}
+
+int barrido_iniciar(const struct sweep_config *cfg)
+{
+	/* Sin ISR hasta hal_pwm_sweep_start(): nada más toca 'sweep' */
+	barrido_detener();
+	if (sweep_init(&sweep, cfg, SWEEP_TIM1_HZ) != 0)
+		return -1;
+
+	mitades_tras_fin = 0;
+
+	hal_pwm_sweep_start(sweep.psc);
+	barrido_en_curso = 1;
+	return 0;
+}
+
+void barrido_detener(void)
+{
+	hal_pwm_sweep_stop();
+	barrido_en_curso = 0;
+}
+
+int barrido_activo(void)
 {
-	uint32_t acc = 0;
-	for (unsigned i = 0; i < n; ++i) acc += buf[i];
-	return (uint16_t)(acc / n);
+	return barrido_en_curso;
 }
+#endif
 
 
 /* ========= Tareas de la Aplicación ========= */
@@ -52,7 +206,7 @@ vTaskLed(void *pvParameters) {
 
 	for (;;) {
 		/* Conmuta el estado del LED */
-		gpio_toggle(GPIOC,GPIO13);
+		hal_led_toggle();
 		
 		/*
 		 * Demora RTOS-friendly.
@@ -64,84 +218,142 @@ vTaskLed(void *pvParameters) {
 }
 
 /**
- * @brief Tarea de lectura periódica del ADC (Lógica de iniciar_entradas_adc).
+ * @brief Tarea de lectura del ADC (Lógica de iniciar_entradas_adc).
+ *
+ * En cada ejecución toma el promedio de TODAS las conversiones hechas
+ * desde la anterior (diferencia de los totales de la ISR del DMA).
+ * Con APP_EVENT_DRIVEN la despierta la ISR en cada bloque y despierta a
+ * vTaskControlPWM cuando el valor filtrado cambia más de
+ * ADC_UMBRAL_CAMBIO; si no, se ejecuta cada 10ms.
  */
 void
 vTaskReadAnalog(void *pvParameters)
 {
 	(void)pvParameters;
 
+#if APP_EVENT_DRIVEN
+	/* Último par notificado (imposible al inicio: fuerza la 1a salida) */
+	struct adc_snapshot notified = { .amp_raw = 0xFFFF, .freq_raw = 0xFFFF };
+#else
 	/* Inicializa vTaskDelayUntil para una ejecución periódica precisa */
 	TickType_t xLastWakeTime = xTaskGetTickCount();
 	const TickType_t xFrequency = pdMS_TO_TICKS(10); // 10ms -> 100Hz
+#endif
+
+	struct adc_totals prev;
+	adc_get_totals(&prev);
 
 	for (;;)
 	{
-		/* 1. Espera hasta que sea el momento de la próxima ejecución */
+		/* 1. Espera al próximo bloque del DMA (o al próximo período) */
+#if APP_EVENT_DRIVEN
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#else
 		vTaskDelayUntil(&xLastWakeTime, xFrequency);
-
-		/* 2. Copia atómica del búfer de DMA (protegido contra cambios de tarea) */
-		uint16_t amp, freq;
-		taskENTER_CRITICAL(); // Reemplaza cm_disable_interrupts()
-		{
-			amp  = adc_dma_buffer[0];
-			freq = adc_dma_buffer[1];
-		}
-		taskEXIT_CRITICAL(); // Reemplaza cm_enable_interrupts()
-
-		/* 3. Actualiza los búferes de promedio (protegido por Mutex) */
-		if (xAdcMutex != NULL)
+#endif
+
+		/* 2. Promedio de los bloques recibidos desde la última vez
+		 *    (aritmética módulo 2^32: correcta aunque los totales den
+		 *    la vuelta) */
+		struct adc_totals now;
+		adc_get_totals(&now);
+
+		uint32_t pairs = now.pairs - prev.pairs;
+		if (pairs == 0)
+			continue;	// DMA detenido: se mantiene el último valor
+
+		uint16_t amp  = (uint16_t)((now.amp_sum - prev.amp_sum) / pairs);
+		uint16_t freq = (uint16_t)((now.freq_sum - prev.freq_sum) / pairs);
+		prev = now;
+
+		/* 3. Actualiza los promedios, O(1) (sólo esta tarea los usa) */
+		mavg_push(&amp_filter, amp);
+		mavg_push(&freq_filter, freq);
+
+		/* 4. Publica el par filtrado sin bloqueos */
+		struct adc_snapshot snap = {
+			.amp_raw  = mavg_value(&amp_filter),
+			.freq_raw = mavg_value(&freq_filter),
+		};
+		seqlatch_write_begin(&adc_latch);
+		adc_published[0] = snap;
+		seqlatch_write_next(&adc_latch);
+		adc_published[1] = snap;
+
+#if APP_EVENT_DRIVEN
+		/* 5. Despierta al control sólo si el cambio es significativo
+		 *    (con PID, en cada bloque: el lazo necesita período fijo) */
+		if (CONTROL_PID ||
+		    __abs_diff_u16(snap.amp_raw, notified.amp_raw) > ADC_UMBRAL_CAMBIO ||
+		    __abs_diff_u16(snap.freq_raw, notified.freq_raw) > ADC_UMBRAL_CAMBIO)
 		{
-			/* Espera hasta 10 ticks (ms) para obtener el mutex */
-			if (xSemaphoreTake(xAdcMutex, (TickType_t)10) == pdTRUE)
-			{
-				/* Sección crítica (acceso a datos compartidos) */
-				amp_buffer[idx_pid]  = amp;
-				freq_buffer[idx_pid] = freq;
-				idx_pid = (idx_pid + 1) % MUESTRAS_PID;
-				
-				xSemaphoreGive(xAdcMutex);
-			}
-			/* Si no se obtiene el mutex, simplemente omitimos esta muestra.
-			 * Esto evita bloquear la tarea del ADC. */
+			notified = snap;
+			xTaskNotifyGive(xTaskPwmCtrlHandle);
 		}
+#endif
 	}
 }
 
 
 /* ========= API de Getters (Implementación) ========= */
 
+void adc_get_totals(struct adc_totals *totals)
+{
+	uint32_t s;
+	do {
+		s = seqlatch_read_begin(&totals_latch);
+		*totals = totals_published[seqlatch_index(s)];
+	} while (seqlatch_read_retry(&totals_latch, s));
+}
+
+void adc_get_snapshot(struct adc_snapshot *snap)
+{
+	uint32_t s;
+	do {
+		s = seqlatch_read_begin(&adc_latch);
+		*snap = adc_published[seqlatch_index(s)];
+	} while (seqlatch_read_retry(&adc_latch, s));
+}
+
+uint16_t adc_get_amplitud_raw(void)
+{
+	struct adc_snapshot snap;
+	adc_get_snapshot(&snap);
+	return snap.amp_raw;
+}
+
+uint16_t adc_get_frecuencia_raw(void)
+{
+	struct adc_snapshot snap;
+	adc_get_snapshot(&snap);
+	return snap.freq_raw;
+}
+
 float adc_get_amplitud_volts(void)
 {
-	uint16_t avg_raw = 0;
-	if (xAdcMutex != NULL)
-	{
-		if (xSemaphoreTake(xAdcMutex, (TickType_t)10) == pdTRUE)
-		{
-			/* Lee el búfer de promedio de forma segura */
-			avg_raw = __avg_u16(amp_buffer, MUESTRAS_PID);
-			xSemaphoreGive(xAdcMutex);
-		}
-	}
-	return __u12_to_volts(avg_raw);
+	return __u12_to_volts(adc_get_amplitud_raw());
 }
 
 float adc_get_frecuencia_volts(void)
 {
-	uint16_t avg_raw = 0;
-	if (xAdcMutex != NULL)
-	{
-		if (xSemaphoreTake(xAdcMutex, (TickType_t)10) == pdTRUE)
-		{
-			/* Lee el búfer de promedio de forma segura */
-			avg_raw = __avg_u16(freq_buffer, MUESTRAS_PID);
-			xSemaphoreGive(xAdcMutex);
-		}
-	}
-	return __u12_to_volts(avg_raw);
+	return __u12_to_volts(adc_get_frecuencia_raw());
 }
 
 
+#if CONTROL_PID
+/* Ganancias de los lazos PID, en Q16.16 por muestra (ver app_tasks.h) */
+static const struct pid_gains pid_gains = {
+	.kp  = PID_Q16(PID_KP),
+	.ki  = PID_Q16(PID_KP * PID_PERIODO_S / PID_TI_S),
+	.kd  = PID_Q16(PID_KP * PID_TD_S / PID_PERIODO_S),
+	.kaw = PID_Q16(PID_PERIODO_S / PID_TT_S),
+	.d_shift = PID_D_SHIFT,
+};
+
+/* Estado de los lazos (sólo los usa vTaskControlPWM; fuera de su pila) */
+static struct pid pid_amp, pid_freq;
+#endif
+
 /**
  * @brief Tarea de control principal (PID y Salida PWM).
  */
@@ -150,72 +362,77 @@ vTaskControlPWM(void *pvParameters)
 {
 	(void)pvParameters;
 
-	/* * Constantes para la conversión.
-	 * (Setpoint Voltaje = 2.0V)
-	 * (Setpoint Freq = 10000 Hz)
-	 * (Setpoint Amplitud Vpp = 2.0V) -> Duty Cycle = 2.0/3.3 = 60.6%
-	 */
-	const float SETPOINT_VOLTS = 2.0f;
-	const float MAX_VOLTS = 3.3f;
-	const float TARGET_FREQ_HZ = 10000.0f;
-	const float TARGET_DUTY_PCT = 2.0f / 3.3f; // 60.6%
-
-	/* * El reloj del TIM1 es 72MHz.
-	 * Periodo (ARR) = (72,000,000 / Frecuencia) - 1
-	 * CCR = (ARR + 1) * Duty_Cycle_Percent
-	 */
-	const uint32_t TIM_CLOCK_HZ = 72000000;
-	
+#if !APP_EVENT_DRIVEN
 	/* Ejecuta esta tarea de control a 50Hz (cada 20ms) */
 	TickType_t xLastWakeTime = xTaskGetTickCount();
 	const TickType_t xFrequency = pdMS_TO_TICKS(20);
+#endif
+
+#if CONTROL_PID
+	/* El primer ciclo inicializa los PID */
+	int pid_listo = 0;
+#endif
 
 	for (;;)
 	{
-		/* 1. Espera para el próximo ciclo de control */
+		/* 1. Espera para el próximo ciclo de control (o a un cambio) */
+#if APP_EVENT_DRIVEN
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#else
 		vTaskDelayUntil(&xLastWakeTime, xFrequency);
-
-		/* 2. Lee los valores de los "potenciómetros" (de forma segura) */
-		float fAmplitudVolts = adc_get_amplitud_volts();
-		float fFrecuenciaVolts = adc_get_frecuencia_volts();
-
-		/* * 3. Lógica de Mapeo (Requisitos 2 y 3)
-		 * "cuando en el pin de entrada hay 2Vdc"
-		 * Asumiremos una relación lineal simple por ahora (sin PID).
-		 * * Mapeo de Frecuencia:
-		 * Si 2.0V -> 10,000 Hz
-		 * f(V) = (V / 2.0V) * 10,000 Hz
-		 */
-		float nueva_frec_hz = (fFrecuenciaVolts / SETPOINT_VOLTS) * TARGET_FREQ_HZ;
-		
-		/* Asegura que la frecuencia no sea cero (evita división por cero) */
-		if (nueva_frec_hz < 100.0f) { // Límite inferior de 100Hz
-			nueva_frec_hz = 100.0f;
+#endif
+
+		/* 2. Lee los valores de los "potenciómetros" (par coherente) */
+		struct adc_snapshot snap;
+		adc_get_snapshot(&snap);
+		uint16_t amp_cmd = snap.amp_raw;
+		uint16_t freq_cmd = snap.freq_raw;
+
+#if CONTROL_PID
+		/* 3. Lazo cerrado: el PID da el código de mando de cada canal.
+		 *    Arranca desde el mismo punto que el mapeo lineal (sin salto). */
+		if (!pid_listo) {
+			pid_init(&pid_amp, &pid_gains, 0, CONTROL_ADC_FULL_SCALE);
+			pid_init(&pid_freq, &pid_gains, 0, CONTROL_ADC_FULL_SCALE);
+			pid_reset(&pid_amp, snap.amp_raw, snap.amp_raw);
+			pid_reset(&pid_freq, snap.freq_raw, snap.freq_raw);
+			pid_listo = 1;
 		}
-
-		/* * Mapeo de Amplitud (Duty Cycle):
-		 * Si 2.0V -> 60.6% Duty
-		 * d(V) = (V / 2.0V) * 60.6%
+#if CONTROL_PID_AMP
+		amp_cmd = (uint16_t)pid_step(&pid_amp, CONTROL_SETPOINT_RAW, snap.amp_raw);
+#endif
+#if CONTROL_PID_FREQ
+		freq_cmd = (uint16_t)pid_step(&pid_freq, CONTROL_SETPOINT_RAW, snap.freq_raw);
+#endif
+#endif
+
+		/* * 4. Lógica de Mapeo (Requisitos 2 y 3)
+		 * "cuando en el pin de entrada hay 2Vdc"
+		 * Relación lineal simple, ver control.c. Sin PID el mando es
+		 * directamente la lectura del ADC.
+		 * Con CONTROL_FIXED_POINT = 1 no se usa float en todo el camino
+		 * desde el código del ADC hasta ARR/CCR.
 		 */
-		float nuevo_duty_pct = (fAmplitudVolts / SETPOINT_VOLTS) * TARGET_DUTY_PCT;
-
-		/* Limita el duty cycle entre 0% y 100% */
-		if (nuevo_duty_pct > 1.0f) nuevo_duty_pct = 1.0f;
-		if (nuevo_duty_pct < 0.0f) nuevo_duty_pct = 0.0f;
+		struct control_output out;
+		control_map(amp_cmd, freq_cmd, &out);
 
-
-		/* * 4. Aplicar nuevos valores al Timer (Hardware)
+		/* * 5. Aplicar nuevos valores al Timer (Hardware)
 		 * NOTA: Esto NO está protegido por un mutex (como pide el Req. 7).
 		 * Lo añadiremos después.
 		 */
-		
-		/* Actualiza Frecuencia (Período ARR) */
-		uint32_t nuevo_periodo_arr = (TIM_CLOCK_HZ / nueva_frec_hz) - 1;
-		timer_set_period(TIM1, nuevo_periodo_arr);
-
-		/* Actualiza Amplitud (Duty Cycle CCR) */
-		/* (nuevo_periodo_arr + 1) == (TIM_CLOCK_HZ / nueva_frec_hz) */
-		uint32_t nuevo_ccr = (uint32_t)((float)(nuevo_periodo_arr + 1) * nuevo_duty_pct);
-		timer_set_oc_value(TIM1, TIM_OC1, nuevo_ccr);
+#if HAL_PWM_DDS
+		/* Generador: la frecuencia da el incremento de fase y el duty
+		 * la amplitud; las muestras las pone la ISR del DMA */
+		dds_set_output(&dds, freq_cmd * CONTROL_DDS_INC_K(HAL_DDS_FS_HZ),
+			       out.duty_q16);
+#elif HAL_PWM_DITHER
+		hal_pwm_set_duty(out.psc, out.period_arr, out.duty_q16);
+#elif HAL_PWM_SWEEP
+		/* Durante un barrido el TIM1 es del DMA */
+		if (!barrido_activo())
+			hal_pwm_set(out.psc, out.period_arr, out.ccr);
+#else
+		hal_pwm_set(out.psc, out.period_arr, out.ccr);
+#endif
 	}
 }
\ No newline at end of file
@@ -1,17 +1,125 @@
 #ifndef APP_TASKS_H
 #define APP_TASKS_H
 
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "hal.h"
+#include "sweep.h"
+
 /* ========= Constantes de la Aplicación ========= */
 
-/* Tamaño del promedio (PID). */
-#define MUESTRAS_PID 8
+/* Tamaño del promedio (PID), en potencias de dos: 2^3 = 8 muestras. */
+#define MUESTRAS_PID_LOG2 3
+#define MUESTRAS_PID (1U << MUESTRAS_PID_LOG2)
+
+/* Ventana de cada canal (2^n muestras, hasta 2^20; ver mavg.h). */
+#ifndef FILTRO_AMP_LOG2
+#define FILTRO_AMP_LOG2 MUESTRAS_PID_LOG2
+#endif
+#ifndef FILTRO_FREQ_LOG2
+#define FILTRO_FREQ_LOG2 MUESTRAS_PID_LOG2
+#endif
 
 /* VREF por defecto (voltios) para conversión. */
 #define VREF_VOLTS 3.3f
 
 
+/*
+ * Cadena ADC -> control:
+ *	1 = Por eventos (por defecto): la ISR del DMA notifica a
+ *	    vTaskReadAnalog en cada bloque, y ésta notifica a vTaskControlPWM
+ *	    sólo cuando el valor filtrado cambia más de ADC_UMBRAL_CAMBIO.
+ *	0 = Por sondeo: 10ms (ADC) y 20ms (control), sin relación de fase.
+ */
+#ifndef APP_EVENT_DRIVEN
+#define APP_EVENT_DRIVEN 1
+#endif
+
+/* Cambio mínimo (códigos de 12 bits, ~6mV) que despierta al control. */
+#define ADC_UMBRAL_CAMBIO 8
+
+
+/*
+ * Lazos PID (con CONTROL_PID_AMP / CONTROL_PID_FREQ, ver control.h).
+ * Período de muestreo: un bloque del DMA por eventos (3.2ms con el TIM3),
+ * 20ms por sondeo. Las ganancias se dan en forma estándar y se pasan a
+ * Q16.16 por muestra al compilar; mismas para los dos lazos (ganancia
+ * unidad entre código de mando y código de realimentación).
+ */
+#if APP_EVENT_DRIVEN
+#define PID_PERIODO_S	((double)HAL_ADC_BLOCK_PAIRS / HAL_ADC_PAIR_RATE_HZ)
+#else
+#define PID_PERIODO_S	0.020
+#endif
+
+#ifndef PID_KP
+#define PID_KP		0.5	// Ganancia proporcional
+#endif
+#ifndef PID_TI_S
+#define PID_TI_S	0.020	// Tiempo integral (s)
+#endif
+#ifndef PID_TD_S
+#define PID_TD_S	0.0	// Tiempo derivativo (s)
+#endif
+#ifndef PID_TT_S
+#define PID_TT_S	0.005	// Anti-windup: tiempo de seguimiento (s)
+#endif
+#define PID_D_SHIFT	2	// Filtro de la derivada: N = 4 muestras
+
+
 /* ========= Tareas ========= */
 
+/*
+ * Pilas de las tareas, en palabras. Con PILAS_CALCULADAS, las de peor
+ * caso que escribe "make pilas" en pilas.h (grafo de llamadas, ver
+ * host/pilas.c) más un margen para lo que el análisis no ve.
+ */
+#ifndef PILAS_CALCULADAS
+#define PILAS_CALCULADAS 0
+#endif
+
+#if PILAS_CALCULADAS
+#include "pilas.h"
+#ifndef PILA_MARGEN
+#define PILA_MARGEN	16
+#endif
+#define PILA_LED	(PILA_LED_CALCULADA + PILA_MARGEN)
+#define PILA_ADC	(PILA_ADC_CALCULADA + PILA_MARGEN)
+#define PILA_PWM	(PILA_PWM_CALCULADA + PILA_MARGEN)
+#else
+#define PILA_LED	100
+#define PILA_ADC	128
+#define PILA_PWM	128
+#endif
+
+/*
+ * Crea una tarea como xTaskCreate(), sin parámetro. Con MEMORIA_ESTATICA
+ * la pila y el TCB son estáticos propios de cada llamada (.bss): no
+ * puede fallar, y 'handle' (o NULL) recibe el handle igualmente.
+ */
+#if configSUPPORT_STATIC_ALLOCATION
+#define TAREA_CREAR(fn, nombre, palabras, prioridad, handle) do {		\
+		static StackType_t pila_[palabras];				\
+		static StaticTask_t tcb_;					\
+		TaskHandle_t *handle_ = (handle);				\
+		TaskHandle_t h_ = xTaskCreateStatic((fn), (nombre), (palabras),	\
+						    NULL, (prioridad), pila_, &tcb_); \
+		if (handle_ != NULL)						\
+			*handle_ = h_;						\
+	} while (0)
+#else
+#define TAREA_CREAR(fn, nombre, palabras, prioridad, handle) \
+	xTaskCreate((fn), (nombre), (palabras), NULL, (prioridad), (handle))
+#endif
+
+/* Handles de vTaskReadAnalog y vTaskControlPWM (los usan las
+ * notificaciones; main.c los rellena en TAREA_CREAR). */
+extern TaskHandle_t xTaskAdcHandle;
+extern TaskHandle_t xTaskPwmCtrlHandle;
+
 /**
  * @brief Tarea de parpadeo del LED (RTOS-friendly).
  */
@@ -20,13 +128,61 @@ void vTaskLed(void *pvParameters);
 /**
  * @brief Tarea de lectura periódica del ADC.
  *
- * Copia los valores del búfer de DMA a un búfer de promedios,
- * de forma segura (usando un Mutex).
+ * Promedia todas las conversiones entregadas por el DMA desde la
+ * ejecución anterior, las pasa por la media móvil y publica el par
+ * filtrado sin bloqueos (ver seqlatch.h).
  */
 void vTaskReadAnalog(void *pvParameters); // <-- AÑADIDO
 
 
-/* ========= API de Getters (Seguros para Tareas) ========= */
+/* ========= API de Getters (Seguros para Tareas e ISRs) ========= */
+
+/**
+ * @brief Par de valores filtrados (crudos, 12 bits) de un mismo instante.
+ */
+struct adc_snapshot {
+	uint16_t amp_raw;	// Amplitud (PA0)
+	uint16_t freq_raw;	// Frecuencia (PA1)
+};
+
+/**
+ * @brief Totales de todas las conversiones del ADC desde el arranque.
+ *
+ * Los acumula la ISR del DMA, un medio búfer cada vez. Son contadores
+ * módulo 2^32: se usan por diferencias entre dos lecturas.
+ */
+struct adc_totals {
+	uint32_t amp_sum;	// Suma de muestras de Amplitud
+	uint32_t freq_sum;	// Suma de muestras de Frecuencia
+	uint32_t pairs;		// Pares {amp, freq} sumados
+	uint32_t blocks;	// Medios búferes procesados
+};
+
+/**
+ * @brief Copia los totales actuales (mismas garantías que adc_get_snapshot).
+ */
+void adc_get_totals(struct adc_totals *totals);
+
+/**
+ * @brief Copia el último par filtrado publicado por vTaskReadAnalog.
+ *
+ * Nunca bloquea ni llama al kernel. Desde una ISR no reintenta nunca;
+ * desde una tarea sólo reintenta si se publica un par nuevo durante
+ * la copia.
+ */
+void adc_get_snapshot(struct adc_snapshot *snap);
+
+/**
+ * @brief Obtiene el valor promedio crudo (12 bits) de Amplitud.
+ * @return Valor filtrado (0 a 4095).
+ */
+uint16_t adc_get_amplitud_raw(void);
+
+/**
+ * @brief Obtiene el valor promedio crudo (12 bits) de Frecuencia.
+ * @return Valor filtrado (0 a 4095).
+ */
+uint16_t adc_get_frecuencia_raw(void);
 
 /**
  * @brief Obtiene el valor promedio de Amplitud en Volts.
@@ -41,6 +197,40 @@ float adc_get_amplitud_volts(void); // <-- AÑADIDO
 float adc_get_frecuencia_volts(void); // <-- AÑADIDO
 
 
+#if HAL_PWM_DDS
+/**
+ * @brief Elige la forma de onda del generador DDS (dds_seno,
+ *        dds_triangulo o una tabla propia de DDS_LUT_LEN valores Q15).
+ */
+void dds_set_forma_onda(const int16_t *tabla);
+#endif
+
+#if HAL_PWM_SWEEP
+/**
+ * @brief Arranca un barrido de frecuencia en el PWM (ver sweep.h).
+ *
+ * Detiene el barrido en curso, si lo hay. Mientras dure,
+ * vTaskControlPWM no toca el TIM1; al terminar (sin 'repetir') el DMA se
+ * para, el PWM se queda en la frecuencia final y vuelve al mando de los
+ * potenciómetros en el próximo ciclo de control (con APP_EVENT_DRIVEN,
+ * en el próximo cambio). Desde una tarea o antes de arrancar el
+ * scheduler.
+ * @return 0, o -1 si la configuración no es realizable.
+ */
+int barrido_iniciar(const struct sweep_config *cfg);
+
+/**
+ * @brief Detiene el barrido en curso.
+ */
+void barrido_detener(void);
+
+/**
+ * @brief 1 mientras el DMA esté cargando los períodos del barrido.
+ */
+int barrido_activo(void);
+#endif
+
+
 /**
  * @brief Tarea de control principal (PID y Salida PWM).
  *
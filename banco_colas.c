@@ -0,0 +1,114 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "banco_colas.h"
+#include "ciclos.h"
+#include "cola_tipada.h"
+
+#if BANCO_COLAS
+
+struct banco_colas banco_colas;
+
+const char *const banco_colas_nombre[BANCO_MODOS] = {
+	[BANCO_TAREA_UNO]  = "tarea, uno a uno",
+	[BANCO_TAREA_LOTE] = "tarea, por lotes",
+	[BANCO_ISR_UNO]    = "ISR, uno a uno",
+	[BANCO_ISR_LOTE]   = "ISR, por lotes",
+};
+
+/* Cabe un lote de más: nunca se llena */
+#define LARGO		(2 * BANCO_COLAS_LOTE)
+#define MAX_BYTES	8
+
+COLA_TIPADA(cola_2, uint16_t, LARGO);
+COLA_TIPADA(cola_4, uint32_t, LARGO);
+COLA_TIPADA(cola_8, uint64_t, LARGO);
+
+static const uint8_t bytes[BANCO_COLAS_TAMANOS] = {
+	sizeof(cola_2_tipo_t), sizeof(cola_4_tipo_t), sizeof(cola_8_tipo_t)
+};
+
+static uint8_t fuente[BANCO_COLAS_LOTE * MAX_BYTES];
+static uint8_t destino[BANCO_COLAS_LOTE * MAX_BYTES];
+
+static QueueHandle_t __crear(unsigned t)
+{
+	switch (t) {
+	case 0:
+		return cola_2_crear();
+	case 1:
+		return cola_4_crear();
+	default:
+		return cola_8_crear();
+	}
+}
+
+/* Un lote de ida y vuelta; ciclos */
+static uint32_t __vuelta(QueueHandle_t q, unsigned b, enum banco_colas_modo m)
+{
+	BaseType_t w = pdFALSE;
+	uint32_t t0 = ciclos_leer();
+
+	switch (m) {
+	case BANCO_TAREA_UNO:
+		for (unsigned i = 0; i < BANCO_COLAS_LOTE; ++i)
+			xQueueSend(q, &fuente[i * b], 0);
+		for (unsigned i = 0; i < BANCO_COLAS_LOTE; ++i)
+			xQueueReceive(q, &destino[i * b], 0);
+		break;
+	case BANCO_TAREA_LOTE:
+		xQueueSendMultiple(q, fuente, BANCO_COLAS_LOTE, 0);
+		xQueueReceiveMultiple(q, destino, BANCO_COLAS_LOTE, 0);
+		break;
+	case BANCO_ISR_UNO:
+		for (unsigned i = 0; i < BANCO_COLAS_LOTE; ++i)
+			xQueueSendFromISR(q, &fuente[i * b], &w);
+		for (unsigned i = 0; i < BANCO_COLAS_LOTE; ++i)
+			xQueueReceiveFromISR(q, &destino[i * b], &w);
+		break;
+	default:
+		xQueueSendMultipleFromISR(q, fuente, BANCO_COLAS_LOTE, &w);
+		xQueueReceiveMultipleFromISR(q, destino, BANCO_COLAS_LOTE, &w);
+		break;
+	}
+	return ciclos_leer() - t0;
+}
+
+void banco_colas_medir(void)
+{
+	ciclos_init();
+	for (unsigned i = 0; i < sizeof(fuente); ++i)
+		fuente[i] = (uint8_t)i;
+
+	for (unsigned t = 0; t < BANCO_COLAS_TAMANOS; ++t) {
+		QueueHandle_t q = __crear(t);
+
+		banco_colas.tam[t].bytes = bytes[t];
+		if (q == NULL)
+			continue;
+		for (unsigned m = 0; m < BANCO_MODOS; ++m) {
+			uint32_t min = UINT32_MAX;
+
+			for (unsigned v = 0; v < BANCO_COLAS_VUELTAS; ++v) {
+				uint32_t c = __vuelta(q, bytes[t], m);
+				if (c < min)
+					min = c;
+			}
+			banco_colas.tam[t].ciclos[m] =
+				(min + BANCO_COLAS_LOTE / 2) / BANCO_COLAS_LOTE;
+		}
+	}
+	banco_colas.hecho = 1;
+}
+
+void vTaskBancoColas(void *args)
+{
+	(void)args;
+
+	banco_colas_medir();
+	for (;;)
+		vTaskDelay(portMAX_DELAY);
+}
+
+#endif // BANCO_COLAS
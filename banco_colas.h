@@ -0,0 +1,71 @@
+#ifndef BANCO_COLAS_H
+#define BANCO_COLAS_H
+
+#include <stdint.h>
+
+/*
+ * Medida en el target (y en el host) del coste de las colas del kernel
+ * por elemento: xQueueSend()/xQueueReceive() uno a uno frente a
+ * xQueueSendMultiple()/xQueueReceiveMultiple() por lotes de
+ * BANCO_COLAS_LOTE, desde tarea y con las variantes FromISR, para
+ * elementos pequeños (muestras de 2, 4 y 8 bytes).
+ *
+ * Con BANCO_COLAS = 1 main.c crea vTaskBancoColas, que mide una vez al
+ * arrancar y deja el resultado en 'banco_colas' para leerlo con el
+ * depurador ("print banco_colas" en gdb). Cada cifra es el mínimo entre
+ * BANCO_COLAS_VUELTAS vueltas (un lote enviado y recibido), para que no
+ * cuenten las interrupciones que caigan en medio, en ciclos de ciclos.h
+ * (DWT_CYCCNT a 72 MHz; el TSC en el host) por elemento, enviar y
+ * recibir incluidos. Sin bloqueos: la cola nunca se llena ni se vacía.
+ * Las colas son de cola_tipada.h; compilando con COLA_COPIA_PEQUENA=0 se
+ * mide la copia por memcpy() para comparar (ver queue.c).
+ *
+ * En el host, bench/bench_cola.c llama a banco_colas_medir().
+ */
+
+#ifndef BANCO_COLAS
+#define BANCO_COLAS		0
+#endif
+
+#define BANCO_COLAS_LOTE	16
+#define BANCO_COLAS_VUELTAS	256
+
+/* Pila y prioridad de vTaskBancoColas: lo más baja, mide sin molestar */
+#define PILA_BANCO_COLAS	128
+#define PRIORIDAD_BANCO_COLAS	(tskIDLE_PRIORITY + 1)
+
+enum banco_colas_modo {
+	BANCO_TAREA_UNO,		// xQueueSend / xQueueReceive
+	BANCO_TAREA_LOTE,		// xQueueSendMultiple / xQueueReceiveMultiple
+	BANCO_ISR_UNO,			// xQueueSendFromISR / xQueueReceiveFromISR
+	BANCO_ISR_LOTE,			// ...MultipleFromISR
+	BANCO_MODOS
+};
+
+#define BANCO_COLAS_TAMANOS	3	// Elementos de 2, 4 y 8 bytes
+
+struct banco_colas {
+	uint32_t hecho;			// 1 cuando los datos son válidos
+	struct {
+		uint32_t bytes;		// Tamaño del elemento
+		uint32_t ciclos[BANCO_MODOS];	// Por elemento, mínimo
+	} tam[BANCO_COLAS_TAMANOS];
+};
+
+extern struct banco_colas banco_colas;
+
+extern const char *const banco_colas_nombre[BANCO_MODOS];
+
+/**
+ * @brief Hace todas las medidas y las deja en banco_colas.
+ *
+ * Desde una tarea, con el scheduler en marcha o antes de arrancarlo.
+ */
+void banco_colas_medir(void);
+
+/**
+ * @brief Tarea: banco_colas_medir() una vez y después nada.
+ */
+void vTaskBancoColas(void *args);
+
+#endif // BANCO_COLAS_H
@@ -0,0 +1,129 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "app_tasks.h"
+#include "banco_mutex.h"
+#include "ciclos.h"
+#include "mutex_rapido.h"
+
+#if BANCO_MUTEX
+
+struct banco_mutex banco_mutex;
+
+const char *const banco_mutex_nombre[BANCO_MUTEX_TIPOS] = {
+	[BANCO_MUTEX_RAPIDO] = "mutex_rapido",
+	[BANCO_MUTEX_TECHO]  = "mutex_rapido techo",
+	[BANCO_MUTEX_KERNEL] = "mutex del kernel",
+};
+
+static struct mutex_rapido rapido, techo;
+static SemaphoreHandle_t kernel;
+
+static TaskHandle_t rival;
+static volatile unsigned tipo_rival;
+
+static inline void __tomar(unsigned tipo)
+{
+	if (tipo == BANCO_MUTEX_KERNEL)
+		xSemaphoreTake(kernel, portMAX_DELAY);
+	else
+		mutex_rapido_tomar(tipo == BANCO_MUTEX_TECHO ? &techo : &rapido,
+				   portMAX_DELAY);
+}
+
+static inline void __dar(unsigned tipo)
+{
+	if (tipo == BANCO_MUTEX_KERNEL)
+		xSemaphoreGive(kernel);
+	else
+		mutex_rapido_dar(tipo == BANCO_MUTEX_TECHO ? &techo : &rapido);
+}
+
+/* Se bloquea en el mutex que tiene vTaskBancoMutex cada vez que ésta la
+ * despierta */
+static void vTaskRival(void *args)
+{
+	(void)args;
+
+	for (;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		__tomar(tipo_rival);
+		__dar(tipo_rival);
+	}
+}
+
+/* BANCO_MUTEX_LOTE pares sin disputa; ciclos */
+static uint32_t __libre(unsigned tipo)
+{
+	uint32_t t0 = ciclos_leer();
+
+	if (tipo != BANCO_MUTEX_KERNEL) {
+		struct mutex_rapido *m = tipo == BANCO_MUTEX_TECHO ? &techo : &rapido;
+
+		for (unsigned i = 0; i < BANCO_MUTEX_LOTE; ++i) {
+			mutex_rapido_tomar(m, portMAX_DELAY);
+			mutex_rapido_dar(m);
+		}
+	} else {
+		for (unsigned i = 0; i < BANCO_MUTEX_LOTE; ++i) {
+			xSemaphoreTake(kernel, portMAX_DELAY);
+			xSemaphoreGive(kernel);
+		}
+	}
+	return ciclos_leer() - t0;
+}
+
+/* Una vuelta con la rival bloqueada en el mutex; ciclos */
+static uint32_t __disputado(unsigned tipo)
+{
+	__tomar(tipo);
+	uint32_t t0 = ciclos_leer();
+
+	xTaskNotifyGive(rival);		// Corre ya y se bloquea en el mutex
+					// (con techo, no: espera a que se dé)
+	if (uxTaskPriorityGet(NULL) != PRIORIDAD_BANCO_RIVAL)
+		banco_mutex.herencia_mal++;
+	__dar(tipo);			// Otra vez la rival, hasta que espera
+	return ciclos_leer() - t0;
+}
+
+void vTaskBancoMutex(void *args)
+{
+	(void)args;
+
+	ciclos_init();
+	mutex_rapido_init(&rapido);
+	mutex_rapido_init_techo(&techo, PRIORIDAD_BANCO_RIVAL);
+#if configSUPPORT_DYNAMIC_ALLOCATION
+	kernel = xSemaphoreCreateMutex();
+#else
+	static StaticSemaphore_t kernel_mem;
+	kernel = xSemaphoreCreateMutexStatic(&kernel_mem);
+#endif
+	TAREA_CREAR(vTaskRival, "BancoRival", PILA_BANCO_MUTEX,
+		    PRIORIDAD_BANCO_RIVAL, &rival);
+
+	for (unsigned tipo = 0; tipo < BANCO_MUTEX_TIPOS; ++tipo) {
+		uint32_t min_libre = UINT32_MAX, min_disputado = UINT32_MAX;
+
+		tipo_rival = tipo;
+		for (unsigned v = 0; v < BANCO_MUTEX_VUELTAS; ++v) {
+			uint32_t c = __libre(tipo);
+			if (c < min_libre)
+				min_libre = c;
+			c = __disputado(tipo);
+			if (c < min_disputado)
+				min_disputado = c;
+		}
+		banco_mutex.libre[tipo] =
+			(min_libre + BANCO_MUTEX_LOTE / 2) / BANCO_MUTEX_LOTE;
+		banco_mutex.disputado[tipo] = min_disputado;
+	}
+	banco_mutex.hecho = 1;
+
+	for (;;)
+		vTaskDelay(portMAX_DELAY);
+}
+
+#endif // BANCO_MUTEX
@@ -0,0 +1,66 @@
+#ifndef BANCO_MUTEX_H
+#define BANCO_MUTEX_H
+
+#include <stdint.h>
+
+/*
+ * Medida en el target (y en el host) de mutex_rapido.h, con herencia de
+ * prioridad y con techo, frente al mutex del kernel (xSemaphoreTake()/
+ * xSemaphoreGive()), en ciclos de ciclos.h (DWT_CYCCNT a 72 MHz; el TSC
+ * en el host):
+ *
+ *   libre       tomar y dar sin nadie más, por par (mínimo entre
+ *               BANCO_MUTEX_VUELTAS vueltas de BANCO_MUTEX_LOTE pares)
+ *   disputado   una vuelta con disputa: vTaskBancoMutex lo toma y
+ *               despierta a una tarea rival de más prioridad, que se
+ *               bloquea en él y le hereda su prioridad; al darlo pasa a la
+ *               rival, que lo da y vuelve a esperar. Dos cambios de
+ *               contexto incluidos; mínimo entre BANCO_MUTEX_VUELTAS.
+ *               Con techo (el de la rival) la rival no se adelanta al
+ *               dueño ni se bloquea: corre al darlo y lo toma libre
+ *
+ * En cada vuelta disputada se comprueba además que el dueño corre con la
+ * prioridad heredada; 'herencia_mal' cuenta las que no.
+ *
+ * Con BANCO_MUTEX = 1 main.c crea vTaskBancoMutex, que mide una vez al
+ * arrancar y deja el resultado en 'banco_mutex' para leerlo con el
+ * depurador ("print banco_mutex" en gdb). En el host, bench/bench_mutex.c.
+ */
+
+#ifndef BANCO_MUTEX
+#define BANCO_MUTEX		0
+#endif
+
+#define BANCO_MUTEX_LOTE	16
+#define BANCO_MUTEX_VUELTAS	256
+
+/* vTaskBancoMutex lo más baja; la rival justo por encima */
+#define PILA_BANCO_MUTEX	128
+#define PRIORIDAD_BANCO_MUTEX	(tskIDLE_PRIORITY + 1)
+#define PRIORIDAD_BANCO_RIVAL	(tskIDLE_PRIORITY + 2)
+
+enum banco_mutex_tipo {
+	BANCO_MUTEX_RAPIDO,		// mutex_rapido_tomar / mutex_rapido_dar
+	BANCO_MUTEX_TECHO,		// Lo mismo, con techo
+	BANCO_MUTEX_KERNEL,		// xSemaphoreTake / xSemaphoreGive
+	BANCO_MUTEX_TIPOS
+};
+
+struct banco_mutex {
+	uint32_t hecho;			// 1 cuando los datos son válidos
+	uint32_t libre[BANCO_MUTEX_TIPOS];	// Por par tomar + dar
+	uint32_t disputado[BANCO_MUTEX_TIPOS];	// Por vuelta
+	uint32_t herencia_mal;		// Vueltas sin la prioridad heredada o techo
+};
+
+extern struct banco_mutex banco_mutex;
+
+extern const char *const banco_mutex_nombre[BANCO_MUTEX_TIPOS];
+
+/**
+ * @brief Tarea: mide una vez, deja el resultado en banco_mutex y después
+ * nada. Crea ella misma la tarea rival.
+ */
+void vTaskBancoMutex(void *args);
+
+#endif // BANCO_MUTEX_H
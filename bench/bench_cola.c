@@ -0,0 +1,439 @@
+/*
+ * Benchmark en el host de las colas del kernel.
+ *
+ * 1. Elementos pequeños uno a uno frente a xQueueSendMultiple() y
+ *    xQueueReceiveMultiple() por lotes: banco_colas.c, lo mismo que mide
+ *    el target con BANCO_COLAS = 1. bench_cola_memcpy es este mismo
+ *    programa con la copia de elementos por memcpy() de siempre
+ *    (configQUEUE_SMALL_ITEM_COPY = 0): "uno a uno" mide la diferencia.
+ * 2. Préstamo (pvQueueReserve/pvQueueBorrow, configUSE_QUEUE_LOANS)
+ *    frente a la copia de xQueueSend/xQueueReceive, con bloques grandes.
+ *
+ * Un productor llena bloques de muestras de 16 bits (como los del ADC) y
+ * un consumidor las comprueba, a través de una cola de COLA_LARGO bloques:
+ * - copia: el bloque se arma en la pila, xQueueSend() lo copia a la cola
+ *   y xQueueReceive() a otro búfer, las dos veces en sección crítica;
+ * - préstamo: reservar, llenar en el sitio y confirmar; tomar prestado,
+ *   comprobar en el sitio y devolver.
+ * Por tamaño de bloque y orden de prioridades: ciclos por bloque de
+ * extremo a extremo (con los cambios de contexto) y la sección crítica
+ * más larga, que en el target es tiempo con las interrupciones del kernel
+ * enmascaradas.
+ *
+ * Corre el kernel de verdad sobre el puerto del host, compilado aparte sin
+ * los interruptores de la aplicación. Las secciones críticas se miden
+ * envolviendo vPortEnterCritical()/vPortExitCritical() (-Wl,--wrap).
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "banco_colas.h"
+#include "ciclos.h"
+
+#define COLA_LARGO	4
+#define BLOQUES		20000UL
+
+/* Muestras por bloque: 32, 128 y 512 bytes */
+static const unsigned muestras[] = { 16, 64, 256 };
+#define TAMANOS		(sizeof(muestras) / sizeof(muestras[0]))
+#define MAX_MUESTRAS	256
+
+enum { COPIA, PRESTAMO, MODOS };
+static const char *const modos[MODOS] = { "copia   ", "préstamo" };	// Mismo ancho
+
+struct medida {
+	uint32_t t0;			// Al empezar el productor
+	uint32_t ciclos;		// Por bloque
+	uint32_t critica;		// En secciones críticas, por bloque
+	uint32_t p999;			// p99.9 de una sección crítica
+	unsigned long errores;		// Muestras que no llegaron bien
+};
+
+/* Un productor y un consumidor con un orden de prioridades */
+struct pareja {
+	const char *nombre;
+	UBaseType_t prio_productor, prio_consumidor;
+	TaskHandle_t productor, consumidor;
+	struct pareja *siguiente;	// Empieza al acabar ésta (NULL: fin)
+	struct medida m[TAMANOS][MODOS];
+};
+
+static struct pareja parejas[] = {
+	{ .nombre = "consumidor arriba",
+	  .prio_productor = tskIDLE_PRIORITY + 1, .prio_consumidor = tskIDLE_PRIORITY + 2 },
+	{ .nombre = "productor arriba",
+	  .prio_productor = tskIDLE_PRIORITY + 2, .prio_consumidor = tskIDLE_PRIORITY + 1 },
+};
+#define PAREJAS		(sizeof(parejas) / sizeof(parejas[0]))
+
+/* Una cola por tamaño, para todas las parejas (una detrás de otra) */
+static QueueHandle_t cola[TAMANOS];
+static volatile int fin;
+
+/* --- Secciones críticas ------------------------------------------------- */
+
+void __real_vPortEnterCritical(void);
+void __real_vPortExitCritical(void);
+
+/*
+ * Histograma de duraciones en tramos de CRITICA_TRAMO ciclos; el máximo a
+ * secas lo estropea cualquier interrupción del host, el p99.9 no.
+ */
+#define CRITICA_TRAMO	4
+#define CRITICA_TRAMOS	2048
+
+static int sin_medir;			// Sin el coste de medir (banco_colas)
+static unsigned anidadas;
+static uint32_t critica_t0;
+static struct {
+	uint64_t suma;
+	uint32_t n;
+	uint32_t hist[CRITICA_TRAMOS];
+} critica;
+
+void __wrap_vPortEnterCritical(void)
+{
+	__real_vPortEnterCritical();
+	if (sin_medir)
+		return;
+	if (anidadas++ == 0)
+		critica_t0 = ciclos_leer();
+}
+
+/* Antes de salir: el cambio de contexto pendiente no cuenta */
+void __wrap_vPortExitCritical(void)
+{
+	if (sin_medir)
+		;
+	else if (--anidadas == 0) {
+		uint32_t t = ciclos_leer() - critica_t0;
+		uint32_t i = t / CRITICA_TRAMO;
+
+		critica.suma += t;
+		critica.n++;
+		critica.hist[i < CRITICA_TRAMOS ? i : CRITICA_TRAMOS - 1]++;
+	}
+	__real_vPortExitCritical();
+}
+
+static void critica_empezar(void)
+{
+	memset(&critica, 0, sizeof(critica));
+}
+
+static uint32_t critica_p999(void)
+{
+	uint32_t resto = critica.n / 1000, i = CRITICA_TRAMOS;
+
+	while (i-- > 0 && critica.hist[i] <= resto)
+		resto -= critica.hist[i];
+	return (i + 1) * CRITICA_TRAMO;
+}
+
+static void medida_fin(struct medida *r)
+{
+	r->ciclos = (ciclos_leer() - r->t0) / BLOQUES;
+	r->critica = (uint32_t)(critica.suma / BLOQUES);
+	r->p999 = critica_p999();
+}
+
+/* --- Tareas ------------------------------------------------------------- */
+
+static inline void __llenar(uint16_t *b, unsigned n, uint16_t sec)
+{
+	for (unsigned j = 0; j < n; ++j)
+		b[j] = (uint16_t)(sec + j);
+}
+
+static inline unsigned __comprobar(const uint16_t *b, unsigned n, uint16_t sec)
+{
+	unsigned mal = 0;
+
+	for (unsigned j = 0; j < n; ++j)
+		mal += b[j] != (uint16_t)(sec + j);
+	return mal;
+}
+
+static void vTaskProductor(void *args)
+{
+	struct pareja *p = args;
+	uint16_t bloque[MAX_MUESTRAS];
+
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);	// Turno de esta pareja
+
+	for (unsigned t = 0; t < TAMANOS; ++t) {
+		for (unsigned m = 0; m < MODOS; ++m) {
+			critica_empezar();
+			p->m[t][m].t0 = ciclos_leer();
+
+			for (unsigned long i = 0; i < BLOQUES; ++i) {
+				if (m == COPIA) {
+					__llenar(bloque, muestras[t], (uint16_t)i);
+					xQueueSend(cola[t], bloque, portMAX_DELAY);
+				} else {
+					uint16_t *b = pvQueueReserve(cola[t], portMAX_DELAY);
+					__llenar(b, muestras[t], (uint16_t)i);
+					vQueueCommit(cola[t], b);
+				}
+			}
+			/* El consumidor avisa cuando ha vaciado la cola */
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		}
+	}
+
+	if (p->siguiente) {
+		xTaskNotifyGive(p->siguiente->productor);
+		xTaskNotifyGive(p->siguiente->consumidor);
+	} else {
+		fin = 1;
+	}
+	for (;;)
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+static void vTaskConsumidor(void *args)
+{
+	struct pareja *p = args;
+	uint16_t bloque[MAX_MUESTRAS];
+
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+	for (unsigned t = 0; t < TAMANOS; ++t) {
+		for (unsigned m = 0; m < MODOS; ++m) {
+			struct medida *r = &p->m[t][m];
+
+			for (unsigned long i = 0; i < BLOQUES; ++i) {
+				if (m == COPIA) {
+					xQueueReceive(cola[t], bloque, portMAX_DELAY);
+					r->errores += __comprobar(bloque, muestras[t], (uint16_t)i);
+				} else {
+					const uint16_t *b = pvQueueBorrow(cola[t], portMAX_DELAY);
+					r->errores += __comprobar(b, muestras[t], (uint16_t)i);
+					vQueueRelease(cola[t], b);
+				}
+			}
+			medida_fin(r);
+			xTaskNotifyGive(p->productor);
+		}
+	}
+	for (;;)
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+void vApplicationTickHook(void)
+{
+	if (fin)
+		vTaskEndScheduler();
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t pxTask, char *pcTaskName)
+{
+	(void)pxTask;
+	fprintf(stderr, "Desbordamiento de pila en la tarea %s\n", pcTaskName);
+	abort();
+}
+
+/* --- Sin scheduler: el coste de la cola sola ---------------------------- */
+
+/* Envío y recepción seguidos, sin bloquear ni cambiar de contexto */
+static void una_tarea(struct medida r[TAMANOS][MODOS])
+{
+	uint16_t bloque[MAX_MUESTRAS], otro[MAX_MUESTRAS];
+
+	for (unsigned t = 0; t < TAMANOS; ++t) {
+		const unsigned n = muestras[t];
+
+		for (unsigned m = 0; m < MODOS; ++m) {
+			critica_empezar();
+			r[t][m].t0 = ciclos_leer();
+			for (unsigned long i = 0; i < BLOQUES; ++i) {
+				if (m == COPIA) {
+					__llenar(bloque, n, (uint16_t)i);
+					xQueueSend(cola[t], bloque, 0);
+					xQueueReceive(cola[t], otro, 0);
+					r[t][m].errores += __comprobar(otro, n, (uint16_t)i);
+				} else {
+					uint16_t *b = pvQueueReserve(cola[t], 0);
+					__llenar(b, n, (uint16_t)i);
+					vQueueCommit(cola[t], b);
+					const uint16_t *c = pvQueueBorrow(cola[t], 0);
+					r[t][m].errores += __comprobar(c, n, (uint16_t)i);
+					vQueueRelease(cola[t], c);
+				}
+			}
+			medida_fin(&r[t][m]);
+		}
+	}
+}
+
+/* --- Comprobaciones sin scheduler --------------------------------------- */
+
+static int comprobar(const char *que, int bien)
+{
+	printf("  %-52s %s\n", que, bien ? "ok" : "MAL");
+	return bien ? 0 : 1;
+}
+
+/* Lo que no se ve en la medida: la copia espera detrás de un préstamo,
+ * los lotes se cortan donde se llena o se vacía la cola */
+static int comprobaciones(void)
+{
+	QueueHandle_t q = cola[0];
+	uint16_t v = 1, w = 0;
+	int mal = 0;
+
+	printf("comprobaciones (cola de %u)\n", COLA_LARGO);
+
+	uint16_t *r = pvQueueReserve(q, 0);
+	mal += comprobar("envío por copia con una reserva pendiente: espera",
+			 xQueueSend(q, &v, 0) == errQUEUE_FULL);
+	mal += comprobar("huecos libres descuentan la reserva",
+			 uxQueueSpacesAvailable(q) == COLA_LARGO - 1);
+	*r = 0;
+	vQueueCommit(q, r);
+	mal += comprobar("tras confirmar: el envío por copia entra detrás",
+			 xQueueSend(q, &v, 0) == pdPASS && uxQueueMessagesWaiting(q) == 2);
+
+	const uint16_t *b = pvQueueBorrow(q, 0);
+	mal += comprobar("préstamo del primero, en orden", b != NULL && *b == 0);
+	mal += comprobar("recepción por copia con un préstamo pendiente: espera",
+			 xQueueReceive(q, &w, 0) == errQUEUE_EMPTY);
+	mal += comprobar("consultar (peek) sí puede",
+			 xQueuePeek(q, &w, 0) == pdPASS && w == 1);
+	mal += comprobar("el hueco prestado no está libre",
+			 uxQueueSpacesAvailable(q) == COLA_LARGO - 2);
+	vQueueRelease(q, b);
+	mal += comprobar("tras devolver: se recibe el segundo",
+			 xQueueReceive(q, &w, 0) == pdPASS && w == 1);
+
+	/* Vuelta completa al anillo con préstamos encadenados */
+	uint16_t *res[COLA_LARGO];
+	int orden = 1;
+	for (unsigned vuelta = 0; vuelta < 3; ++vuelta) {
+		for (unsigned i = 0; i < COLA_LARGO; ++i) {
+			res[i] = pvQueueReserve(q, 0);
+			if (res[i] == NULL)
+				orden = 0;
+			else
+				*res[i] = (uint16_t)(vuelta * COLA_LARGO + i);
+		}
+		if (pvQueueReserve(q, 0) != NULL)
+			orden = 0;
+		for (unsigned i = 0; orden && i < COLA_LARGO; ++i)
+			vQueueCommit(q, res[i]);
+		const uint16_t *pr[COLA_LARGO];
+		for (unsigned i = 0; orden && i < COLA_LARGO; ++i) {
+			pr[i] = pvQueueBorrow(q, 0);
+			if (pr[i] == NULL || *pr[i] != vuelta * COLA_LARGO + i)
+				orden = 0;
+		}
+		for (unsigned i = 0; orden && i < COLA_LARGO; ++i)
+			vQueueRelease(q, pr[i]);
+	}
+	mal += comprobar("reservas y préstamos encadenados, dando la vuelta", orden);
+	mal += comprobar("cola vacía al final",
+			 uxQueueMessagesWaiting(q) == 0 &&
+			 uxQueueSpacesAvailable(q) == COLA_LARGO);
+
+	/* Lotes: hasta donde quepa, en orden al dar la vuelta */
+	QueueHandle_t qm = xQueueCreate(COLA_LARGO, sizeof(uint16_t));
+	uint16_t ida[2 * COLA_LARGO], vuelta[2 * COLA_LARGO];
+	for (unsigned i = 0; i < 2 * COLA_LARGO; ++i)
+		ida[i] = (uint16_t)(100 + i);
+	xQueueSend(qm, &v, 0);
+	mal += comprobar("lote con la cola casi llena: entra lo que cabe",
+			 xQueueSendMultiple(qm, ida, COLA_LARGO, 0) == COLA_LARGO - 1);
+	mal += comprobar("lote con la cola llena: ninguno",
+			 xQueueSendMultipleFromISR(qm, ida, 1, NULL) == 0);
+	mal += comprobar("recepción por lotes: los que hay, en orden",
+			 xQueueReceiveMultiple(qm, vuelta, 2 * COLA_LARGO, 0) == COLA_LARGO &&
+			 vuelta[0] == v && memcmp(&vuelta[1], ida,
+						  (COLA_LARGO - 1) * sizeof(uint16_t)) == 0);
+	xQueueSend(qm, &v, 0);
+	xQueueReceive(qm, &w, 0);
+	mal += comprobar("lote partido al dar la vuelta al anillo",
+			 xQueueSendMultiple(qm, ida, COLA_LARGO, 0) == COLA_LARGO &&
+			 xQueueReceiveMultipleFromISR(qm, vuelta, COLA_LARGO, NULL) == COLA_LARGO &&
+			 memcmp(vuelta, ida, COLA_LARGO * sizeof(uint16_t)) == 0);
+	r = pvQueueReserve(qm, 0);
+	mal += comprobar("lote con una reserva pendiente: espera",
+			 xQueueSendMultiple(qm, ida, 1, 0) == 0);
+	vQueueCommit(qm, r);
+	vQueueDelete(qm);
+	return mal;
+}
+
+static int imprimir(const char *nombre, struct medida r[TAMANOS][MODOS])
+{
+	int mal = 0;
+
+	for (unsigned t = 0; t < TAMANOS; ++t) {
+		for (unsigned m = 0; m < MODOS; ++m) {
+			printf("%-18s %5zu  %s %8u %8u %12u%s\n",
+			       t == 0 && m == 0 ? nombre : "",
+			       muestras[t] * sizeof(uint16_t), modos[m],
+			       r[t][m].ciclos, r[t][m].critica, r[t][m].p999,
+			       r[t][m].errores ? "  ERRORES" : "");
+			mal |= r[t][m].errores != 0;
+		}
+	}
+	return mal;
+}
+
+int main(void)
+{
+	sin_medir = 1;
+	banco_colas_medir();
+	sin_medir = 0;
+	printf("ciclos del TSC por elemento enviado y recibido (lotes de %u)\n",
+	       BANCO_COLAS_LOTE);
+	printf("%-18s", "");
+	for (unsigned t = 0; t < BANCO_COLAS_TAMANOS; ++t)
+		printf(" %4lu B", (unsigned long)banco_colas.tam[t].bytes);
+	printf("\n");
+	for (unsigned m = 0; m < BANCO_MODOS; ++m) {
+		printf("%-18s", banco_colas_nombre[m]);
+		for (unsigned t = 0; t < BANCO_COLAS_TAMANOS; ++t)
+			printf(" %6lu", (unsigned long)banco_colas.tam[t].ciclos[m]);
+		printf("\n");
+	}
+	printf("\n");
+
+	for (unsigned t = 0; t < TAMANOS; ++t)
+		cola[t] = xQueueCreate(COLA_LARGO, muestras[t] * sizeof(uint16_t));
+
+	if (comprobaciones())
+		return 1;
+
+	static struct medida sola[TAMANOS][MODOS];
+	una_tarea(sola);
+
+	for (unsigned i = 0; i < PAREJAS; ++i) {
+		struct pareja *p = &parejas[i];
+
+		p->siguiente = i + 1 < PAREJAS ? &parejas[i + 1] : NULL;
+		xTaskCreate(vTaskProductor, "Prod", configMINIMAL_STACK_SIZE, p,
+			    p->prio_productor, &p->productor);
+		xTaskCreate(vTaskConsumidor, "Cons", configMINIMAL_STACK_SIZE, p,
+			    p->prio_consumidor, &p->consumidor);
+	}
+	xTaskNotifyGive(parejas[0].productor);
+	xTaskNotifyGive(parejas[0].consumidor);
+
+	/* Vuelve cuando el tick hook llama a vTaskEndScheduler() */
+	vTaskStartScheduler();
+
+	printf("\ncola de %u bloques, %lu bloques por medida; ciclos del TSC "
+	       "por bloque (crítica: dentro de secciones críticas)\n",
+	       COLA_LARGO, BLOQUES);
+	printf("%-18s %5s  %8s %8s %9s %13s\n", "", "bytes", "", "total",
+	       "crítica", "crít. p99.9");
+	int mal = imprimir("una tarea", sola);
+	for (unsigned i = 0; i < PAREJAS; ++i)
+		mal |= imprimir(parejas[i].nombre, parejas[i].m);
+	return mal;
+}
@@ -0,0 +1,76 @@
+/*
+ * Benchmark en el host del dithering del duty (pwm_dither.c).
+ *
+ * Para varios períodos del TIM1 recorre todos los duty en Q16 y compara
+ * el duty medio del patrón (media de los CCR sobre los N períodos) con el
+ * pedido. La resolución efectiva es log2(1 / (2 * error máximo)): sin
+ * dithering el error máximo es media cuenta y quedan log2(ARR + 1) bits.
+ * Comprueba además que el duty medio es monótono y mide el coste de
+ * rellenar el patrón, que es lo único que hace la CPU (una vez por cambio
+ * de duty, no por período).
+ */
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "pwm_dither.h"
+
+#define RELLENOS	2000000
+
+static double now_ns(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+/* Error máximo del duty medio (en fracción de período) y monotonía */
+static double peor_error(uint32_t period, unsigned log2n, int *monotono)
+{
+	uint16_t buf[1U << 16];
+	const uint32_t n = 1U << log2n;
+	double max_err = 0.0, prev = -1.0;
+
+	*monotono = 1;
+	for (uint32_t d = 0; d <= PWM_DUTY_Q16_ONE; ++d) {
+		pwm_dither_fill(buf, log2n, period, d);
+
+		uint32_t sum = 0;
+		for (uint32_t i = 0; i < n; ++i)
+			sum += buf[i];
+		double media = (double)sum / n / period;
+		double err = fabs(media - (double)d / PWM_DUTY_Q16_ONE);
+
+		if (err > max_err) max_err = err;
+		if (media < prev) *monotono = 0;
+		prev = media;
+	}
+	return max_err;
+}
+
+int main(void)
+{
+	static const uint32_t periodos[] = { 72, 720, 7200 };	// 1 MHz, 100 kHz, 10 kHz
+	static const unsigned bits[] = { 0, 2, 4, 6 };
+
+	printf("ARR+1   dither  error máx.   bits efectivos  monótono\n");
+	for (unsigned p = 0; p < sizeof(periodos) / sizeof(periodos[0]); ++p)
+		for (unsigned b = 0; b < sizeof(bits) / sizeof(bits[0]); ++b) {
+			int mono;
+			double e = peor_error(periodos[p], bits[b], &mono);
+			printf("%5lu   %2u bits %10.2e   %6.2f          %s\n",
+			       (unsigned long)periodos[p], bits[b], e,
+			       log2(1.0 / (2.0 * e)), mono ? "sí" : "NO");
+		}
+
+	uint16_t buf[16];
+	uint32_t sink = 0;
+	double t0 = now_ns();
+	for (uint32_t i = 0; i < RELLENOS; ++i) {
+		pwm_dither_fill(buf, 4, 720, i & 0xFFFF);
+		sink += buf[i & 15];
+	}
+	printf("pwm_dither_fill : %.1f ns por patrón de 16 (una vez por cambio de duty)\n",
+	       (now_ns() - t0) / RELLENOS);
+	return sink == 0x5a5a5a5a;	// Evita que se elimine el cálculo
+}
@@ -0,0 +1,100 @@
+/*
+ * Benchmark en el host de la síntesis de frecuencia (fsynth.c).
+ *
+ * Recorre todas las frecuencias enteras de 1 Hz a 1 MHz con el reloj del
+ * TIM1 (72 MHz) y, por década:
+ *	- error relativo máximo de la frecuencia obtenida,
+ *	- ARR + 1 mínimo (resolución del duty),
+ *	- tiempo medio por llamada.
+ * Compara el error con el prescaler mínimo sin búsqueda (una sola
+ * división), que es lo que haría un cálculo directo.
+ *
+ * El peor caso de tiempo es el de las décadas bajas (por debajo de
+ * 1099 Hz), donde se prueban hasta FSYNTH_CANDIDATOS prescalers.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "fsynth.h"
+
+#define RELOJ_HZ	72000000UL
+#define F_MAX_HZ	1000000UL
+#define PASADAS		4
+
+static double now_ns(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+/* Sin búsqueda: prescaler mínimo y ARR redondeado */
+static void solve_directo(uint32_t period_q4, struct fsynth_timer *t)
+{
+	uint32_t p = (period_q4 - 1) / (65536U << FSYNTH_Q) + 1;
+	uint32_t a = (uint32_t)(((uint64_t)period_q4 + (p << FSYNTH_Q) / 2) /
+				(p << FSYNTH_Q));
+	if (a > 65536)
+		a = 65536;
+	t->psc = p - 1;
+	t->arr = a - 1;
+}
+
+static double err_rel(uint32_t f, const struct fsynth_timer *t)
+{
+	double real = (double)RELOJ_HZ / ((double)(t->psc + 1) * (t->arr + 1));
+	double d = real - f;
+	return (d < 0 ? -d : d) / f;
+}
+
+int main(void)
+{
+	double peor_busqueda = 0.0, peor_ns = 0.0;
+	uint32_t sink = 0;
+
+	printf("década          error máx.  (sin búsqueda)  ARR+1 mín.  ns/llamada\n");
+
+	for (uint32_t f0 = 1; f0 < F_MAX_HZ; f0 *= 10) {
+		uint32_t f1 = f0 * 10;
+		double e_max = 0.0, e_dir = 0.0;
+		uint32_t res_min = UINT32_MAX;
+		struct fsynth_timer t;
+
+		for (uint32_t f = f0; f < f1; ++f) {
+			uint32_t period = fsynth_period_q4(RELOJ_HZ, f);
+
+			fsynth_solve(period, &t);
+			double e = err_rel(f, &t);
+			if (e > e_max) e_max = e;
+			if (t.arr + 1 < res_min) res_min = t.arr + 1;
+
+			solve_directo(period, &t);
+			e = err_rel(f, &t);
+			if (e > e_dir) e_dir = e;
+		}
+
+		/* Tiempo de la llamada: se descuenta el de fsynth_period_q4() */
+		double t0 = now_ns();
+		for (int p = 0; p < PASADAS; ++p)
+			for (uint32_t f = f0; f < f1; ++f) {
+				fsynth_solve(fsynth_period_q4(RELOJ_HZ, f), &t);
+				sink += t.arr;
+			}
+		double t1 = now_ns();
+		for (int p = 0; p < PASADAS; ++p)
+			for (uint32_t f = f0; f < f1; ++f)
+				sink += fsynth_period_q4(RELOJ_HZ, f);
+		double ns = ((t1 - t0) - (now_ns() - t1)) / (PASADAS * (f1 - f0));
+
+		if (e_max > peor_busqueda) peor_busqueda = e_max;
+		if (ns > peor_ns) peor_ns = ns;
+
+		printf("%7lu-%-7lu Hz %9.2e   (%9.2e)   %8lu    %6.2f\n",
+		       (unsigned long)f0, (unsigned long)f1 - 1, e_max, e_dir,
+		       (unsigned long)res_min, ns);
+	}
+
+	printf("peor caso       : error %.2e, %.2f ns/llamada (%u candidatos máx.)\n",
+	       peor_busqueda, peor_ns, FSYNTH_CANDIDATOS);
+	return sink == 0x5a5a5a5a;	// Evita que se elimine el cálculo
+}
@@ -0,0 +1,371 @@
+/*
+ * Benchmark en el host de los asignadores: heap_1..heap_5 de rtos/ y
+ * pool.c (bloques fijos), con trazas de peticiones reproducidas.
+ *
+ * Uso: bench_heap [traza]
+ *
+ * Sin argumento usa tres trazas sintéticas (deterministas):
+ *	mensajes	elementos de 24 bytes en una cola de profundidad
+ *			variable (productor/consumidor)
+ *	mixto		tamaños de 8 a 512 bytes (log-uniforme) con vidas
+ *			aleatorias: la que fragmenta
+ *	arranque	objetos permanentes (pilas, TCBs, colas) y después
+ *			mensajes de 16 a 128 bytes en orden FIFO
+ * Una traza grabada es un fichero de texto con líneas "a <id> <bytes>"
+ * (pedir) y "f <id>" (liberar); '#' empieza un comentario.
+ *
+ * Por asignador y traza: latencia de cada llamada (percentiles, en
+ * ciclos del TSC, descontada la lectura del contador), fragmentación
+ * máxima (1 - mayor bloque libre / bytes libres, tras cada llamada),
+ * fallos y el primero: cuántos bytes quedaban libres y el mayor bloque.
+ * Un fallo con libre >= pedido es de fragmentación.
+ *
+ * Todos con configTOTAL_HEAP_SIZE bytes (heap_5: una región; heap_3 es
+ * el malloc() del sistema, sin límite). El pool reparte lo mismo en tres
+ * clases de 32, 128 y 512 bytes. En el host las cabeceras de heap_2/4/5
+ * son de 16 bytes (8 en el target): los fallos llegan algo antes.
+ * Cada combinación corre en un proceso aparte, con el heap sin estrenar.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "bench_heap.h"
+#include "ciclos.h"
+#include "pool.h"
+
+#define MAX_OPS		400000UL
+#define MAX_IDS		4096
+
+/* Sin kernel: las secciones críticas y la suspensión no hacen nada */
+void vPortEnterCritical(void) {}
+void vPortExitCritical(void) {}
+UBaseType_t uxPortSetInterruptMask(void) { return 0; }
+void vPortClearInterruptMask(UBaseType_t m) { (void)m; }
+void vTaskSuspendAll(void) {}
+BaseType_t xTaskResumeAll(void) { return pdFALSE; }
+
+void vPortHostAssert(const char *fichero, unsigned long linea)
+{
+	fprintf(stderr, "assert: %s:%lu\n", fichero, linea);
+	abort();
+}
+
+/* ========= Pool: tres clases ========= */
+
+#define POOL_CLASES	3
+static const size_t pool_tam[POOL_CLASES] = { 32, 128, 512 };
+static struct pool clases[POOL_CLASES];
+static void *pool_mem[configTOTAL_HEAP_SIZE / sizeof(void *)];
+
+static void pool_banco_init(void)
+{
+	uint8_t *m = (uint8_t *)pool_mem;
+
+	for (unsigned c = 0; c < POOL_CLASES; ++c) {
+		clases[c].mem = m;
+		clases[c].tam = pool_tam[c];
+		clases[c].n = (unsigned)(configTOTAL_HEAP_SIZE / POOL_CLASES / pool_tam[c]);
+		pool_init(&clases[c]);
+		m += clases[c].n * pool_tam[c];
+	}
+}
+
+static void *pool_banco_tomar(size_t n)
+{
+	for (unsigned c = 0; c < POOL_CLASES; ++c)
+		if (n <= pool_tam[c])
+			return pool_tomar(&clases[c]);
+	return NULL;
+}
+
+static void pool_banco_soltar(void *b)
+{
+	for (unsigned c = 0; c < POOL_CLASES; ++c)
+		if ((uint8_t *)b >= clases[c].mem &&
+		    (uint8_t *)b < clases[c].mem + clases[c].n * clases[c].tam) {
+			pool_soltar(&clases[c], b);
+			return;
+		}
+}
+
+static size_t pool_banco_libre(void)
+{
+	size_t libre = 0;
+
+	for (unsigned c = 0; c < POOL_CLASES; ++c)
+		libre += (clases[c].n - clases[c].usados) * clases[c].tam;
+	return libre;
+}
+
+static size_t pool_banco_mayor(void)
+{
+	for (unsigned c = POOL_CLASES; c-- > 0;)
+		if (clases[c].libre != NULL)
+			return clases[c].tam;
+	return 0;
+}
+
+static const struct heap_banco pool_banco = {
+	.nombre = "pool",
+	.libera = 1,
+	.clases = 1,
+	.init = pool_banco_init,
+	.tomar = pool_banco_tomar,
+	.soltar = pool_banco_soltar,
+	.libre = pool_banco_libre,
+	.mayor = pool_banco_mayor,
+};
+
+/* ========= Trazas ========= */
+
+struct op {
+	uint8_t pedir;			// 1 = a, 0 = f
+	uint16_t id;
+	uint32_t tam;
+};
+
+static struct op ops[MAX_OPS];
+static unsigned long n_ops;
+
+static uint32_t semilla;
+
+static uint32_t azar(uint32_t n)
+{
+	semilla = semilla * 1664525U + 1013904223U;
+	return (uint32_t)(((uint64_t)(semilla >> 8) * n) >> 24);
+}
+
+static void op(int pedir, unsigned id, uint32_t tam)
+{
+	if (n_ops < MAX_OPS)
+		ops[n_ops++] = (struct op){ (uint8_t)pedir, (uint16_t)id, tam };
+}
+
+/* Productor/consumidor: la cola sube y baja entre 0 y 32 elementos */
+static void traza_mensajes(void)
+{
+	unsigned cabeza = 0, cola = 0, objetivo = 0;
+
+	semilla = 1;
+	while (n_ops < 200000) {
+		if (cabeza == cola + objetivo || cabeza == cola)
+			objetivo = azar(33);
+		if (cabeza - cola < objetivo)
+			op(1, cabeza++ % MAX_IDS, 24);
+		else
+			op(0, cola++ % MAX_IDS, 0);
+	}
+}
+
+/* Vivos aleatorios (hasta 96) de 8..512 bytes, se libera uno al azar */
+static void traza_mixto(void)
+{
+	static uint16_t vivos[96];
+	unsigned n = 0, sig = 0;
+
+	semilla = 2;
+	while (n_ops < 200000) {
+		if (n == 0 || (n < 96 && azar(2))) {
+			uint32_t tam = 8U << azar(7);		// 8..512
+			tam += azar(tam);
+			vivos[n++] = (uint16_t)sig;
+			op(1, sig, tam > 512 ? 512 : tam);
+			sig = (sig + 1) % MAX_IDS;
+		} else {
+			unsigned i = azar(n);
+			op(0, vivos[i], 0);
+			vivos[i] = vivos[--n];
+		}
+	}
+}
+
+/* Objetos permanentes y luego mensajes FIFO de 16..128 bytes */
+static void traza_arranque(void)
+{
+	static const uint32_t permanentes[] = {
+		400, 96, 512, 96, 512, 96, 128, 96, 512, 96, 76, 160, 76, 160,
+	};
+	unsigned id = 0, cola;
+
+	semilla = 3;
+	for (unsigned i = 0; i < sizeof(permanentes) / sizeof(permanentes[0]); ++i)
+		op(1, id++, permanentes[i]);
+	cola = id;
+	while (n_ops < 200000) {
+		if (id - cola < 8 + azar(24))
+			op(1, id++ % MAX_IDS, 16 + azar(113));
+		else
+			op(0, cola++ % MAX_IDS, 0);
+	}
+}
+
+static int traza_fichero(const char *nombre)
+{
+	FILE *f = fopen(nombre, "r");
+	char linea[128];
+	unsigned id, tam;
+
+	if (f == NULL) {
+		perror(nombre);
+		return -1;
+	}
+	while (fgets(linea, sizeof(linea), f))
+		if (sscanf(linea, "a %u %u", &id, &tam) == 2)
+			op(1, id % MAX_IDS, tam);
+		else if (sscanf(linea, "f %u", &id) == 1)
+			op(0, id % MAX_IDS, 0);
+	fclose(f);
+	return 0;
+}
+
+/* ========= Reproducción ========= */
+
+static uint32_t lat_tomar[MAX_OPS], lat_soltar[MAX_OPS];
+
+static int __cmp(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return x < y ? -1 : x > y;
+}
+
+static uint32_t __percentil(uint32_t *v, unsigned long n, double p)
+{
+	return n ? v[(unsigned long)(p * (double)(n - 1))] : 0;
+}
+
+/* Lo que cuesta leer el contador dos veces */
+static uint32_t __vacio(void)
+{
+	uint32_t min = UINT32_MAX;
+
+	for (unsigned i = 0; i < 10000; ++i) {
+		uint32_t t0 = ciclos_leer();
+		uint32_t d = ciclos_leer() - t0;
+		if (d < min)
+			min = d;
+	}
+	return min;
+}
+
+static void reproducir(const char *traza, const struct heap_banco *h)
+{
+	static void *ptr[MAX_IDS];
+	unsigned long nt = 0, ns = 0, fallos = 0, primer = 0;
+	size_t f_pedido = 0, f_libre = 0, f_mayor = 0;
+	double frag = 0.0;
+	const uint32_t vacio = __vacio();
+
+	h->init();
+	for (unsigned long i = 0; i < n_ops; ++i) {
+		const struct op *o = &ops[i];
+		uint32_t t0, t1;
+
+		if (o->pedir) {
+			if (ptr[o->id] != NULL && h->libera)
+				h->soltar(ptr[o->id]);	// Id reutilizado
+			t0 = ciclos_leer();
+			ptr[o->id] = h->tomar(o->tam);
+			t1 = ciclos_leer();
+			lat_tomar[nt++] = t1 - t0 > vacio ? t1 - t0 - vacio : 0;
+			if (ptr[o->id] == NULL && fallos++ == 0) {
+				primer = i;
+				f_pedido = o->tam;
+				f_libre = h->libre();
+				f_mayor = h->mayor();
+			}
+		} else {
+			if (ptr[o->id] == NULL || !h->libera)
+				continue;
+			t0 = ciclos_leer();
+			h->soltar(ptr[o->id]);
+			t1 = ciclos_leer();
+			lat_soltar[ns++] = t1 - t0 > vacio ? t1 - t0 - vacio : 0;
+			ptr[o->id] = NULL;
+		}
+
+		size_t libre = h->libre();
+		if (libre > 0) {
+			double f = 1.0 - (double)h->mayor() / (double)libre;
+			if (f > frag)
+				frag = f;
+		}
+	}
+
+	qsort(lat_tomar, nt, sizeof(uint32_t), __cmp);
+	qsort(lat_soltar, ns, sizeof(uint32_t), __cmp);
+
+	printf("%-9s %-7s %5u %5u %6u   %5u %5u %6u  ", traza, h->nombre,
+	       __percentil(lat_tomar, nt, 0.5), __percentil(lat_tomar, nt, 0.99),
+	       __percentil(lat_tomar, nt, 0.999),
+	       __percentil(lat_soltar, ns, 0.5), __percentil(lat_soltar, ns, 0.99),
+	       __percentil(lat_soltar, ns, 0.999));
+	if (h->clases || h->libre() == 0)
+		printf("   -  ");
+	else
+		printf("%5.1f%%", 100.0 * frag);
+	if (fallos)
+		printf(" %7lu  op %lu: %zu bytes, libres %zu (mayor %zu)%s\n",
+		       fallos, primer, f_pedido, f_libre, f_mayor,
+		       f_libre >= f_pedido && f_mayor < f_pedido ?
+		       (h->clases ? " clase agotada" : " fragmentación") : "");
+	else
+		printf(" %7lu\n", fallos);
+}
+
+int main(int argc, char **argv)
+{
+	static const struct heap_banco *heaps[] = {
+		&heap1, &heap2, &heap3, &heap4, &heap5, &pool_banco,
+	};
+	static const struct {
+		const char *nombre;
+		void (*generar)(void);
+	} sinteticas[] = {
+		{ "mensajes", traza_mensajes },
+		{ "mixto", traza_mixto },
+		{ "arranque", traza_arranque },
+	};
+	const unsigned n_trazas = argc > 1 ? 1 : 3;
+
+	printf("%u bytes por asignador; latencias en ciclos del TSC\n",
+	       (unsigned)configTOTAL_HEAP_SIZE);
+	printf("%-18s%-21s%s\n", "", "pedir", "liberar");
+	printf("%-9s %-7s %5s %5s %6s   %5s %5s %6s  %6s %7s\n", "traza",
+	       "asig.", "p50", "p99", "p99.9", "p50", "p99", "p99.9", "frag.",
+	       "fallos");
+
+	for (unsigned t = 0; t < n_trazas; ++t) {
+		const char *nombre = argc > 1 ? argv[1] : sinteticas[t].nombre;
+
+		n_ops = 0;
+		if (argc > 1) {
+			if (traza_fichero(argv[1]) != 0)
+				return 1;
+		} else {
+			sinteticas[t].generar();
+		}
+
+		for (unsigned h = 0; h < sizeof(heaps) / sizeof(heaps[0]); ++h) {
+			fflush(stdout);
+			pid_t pid = fork();
+			if (pid == 0) {
+				mlockall(MCL_CURRENT);	// Sin fallos de página al medir
+				reproducir(nombre, heaps[h]);
+				fflush(stdout);
+				_exit(0);
+			}
+			int estado;
+			waitpid(pid, &estado, 0);
+			if (!WIFEXITED(estado) || WEXITSTATUS(estado) != 0)
+				return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef BENCH_HEAP_H
+#define BENCH_HEAP_H
+
+#include <stddef.h>
+
+/* Un asignador en la comparación de bench_heap.c */
+struct heap_banco {
+	const char *nombre;
+	int libera;			// 0: vPortFree no devuelve nada (heap_1)
+	int clases;			// Bloques fijos: sin fragmentación externa
+	void (*init)(void);
+	void *(*tomar)(size_t);
+	void (*soltar)(void *);
+	size_t (*libre)(void);		// Bytes libres; 0 = sin datos
+	size_t (*mayor)(void);		// Mayor bloque que se puede pedir
+};
+
+extern const struct heap_banco heap1, heap2, heap3, heap4, heap5;
+
+#endif // BENCH_HEAP_H
@@ -0,0 +1,109 @@
+/*
+ * Benchmark en el host del monitor de pilas (monitor.c).
+ *
+ * 1. Coste de monitor_paso() con 5 pilas de 128 palabras con la mitad
+ *    superior usada, frente a recorrer toda la zona libre de cada una de
+ *    una vez como uxTaskGetStackHighWaterMark().
+ * 2. Que las tareas que aún no ha visitado salen sin medir (y no con 0
+ *    palabras libres), vueltas hasta la primera medida, y que ésta es
+ *    exacta.
+ *
+ * Se enlaza con monitor.c compilado con MONITOR = 1 y sin kernel: las
+ * "tareas" son las pilas simuladas.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define TAREAS		5
+#define PALABRAS	128
+#define PASOS		(4UL * 1000000UL)
+
+static StackType_t pila[TAREAS][PALABRAS];
+
+void vTaskGetInfo(TaskHandle_t xTask, TaskStatus_t *pxTaskStatus,
+		  BaseType_t xGetFreeStackSpace, eTaskState eState)
+{
+	(void)xGetFreeStackSpace;
+	(void)eState;
+	pxTaskStatus->pxStackBase = xTask;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void) { return 0; }
+size_t xPortGetFreeHeapSize(void) { return 0; }
+
+/* vTaskMonitor no se usa */
+TickType_t xTaskGetTickCount(void) { return 0; }
+void vTaskDelayUntil(TickType_t * const pxPreviousWakeTime,
+		     const TickType_t xTimeIncrement) {}
+
+static double now_ns(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+/* Como prvTaskCheckFreeStackSpace(): byte a byte desde la base */
+static unsigned completo(const StackType_t *p)
+{
+	const uint8_t *b = (const uint8_t *)p;
+	unsigned n = 0;
+
+	while (b[n] == 0xA5)
+		n++;
+	return n / sizeof(StackType_t);
+}
+
+int main(void)
+{
+	for (unsigned i = 0; i < TAREAS; ++i) {
+		memset(pila[i], 0xA5, sizeof(pila[i]));
+		for (unsigned j = PALABRAS - 16 * (i + 1); j < PALABRAS; ++j)
+			pila[i][j] = j;		// Usada desde arriba
+		monitor_creada(pila[i], i + 1);
+	}
+
+	struct monitor_registro r;
+	int mal = 0;
+
+	/* El primer paso sólo mira la tarea 1 */
+	monitor_paso();
+	monitor_leer(&r);
+	for (unsigned i = 2; i <= TAREAS; ++i)
+		mal |= r.pila[i].tarea != i || r.pila[i].ini ||
+		       r.pila[i].libre != MONITOR_DESCONOCIDO;
+	printf("sin visitar aún   : %s\n", mal ? "MAL (medidas)" : "sin medir, ok");
+
+	unsigned pasos = 1;
+	while (monitor.vueltas == 0) {
+		monitor_paso();
+		pasos++;
+	}
+
+	monitor_leer(&r);
+	printf("primera vuelta    : %u pasos de %u palabras\n", pasos, MONITOR_TRAMO);
+	for (unsigned i = 1; i <= TAREAS; ++i) {
+		int bien = r.pila[i].ini && r.pila[i].libre == completo(pila[i - 1]);
+		printf("  tarea %u         : %u palabras libres (%s)\n", i,
+		       r.pila[i].libre, bien ? "exacto" : "MAL");
+		mal |= !bien;
+	}
+
+	double t0 = now_ns();
+	for (unsigned long i = 0; i < PASOS; ++i)
+		monitor_paso();
+	printf("monitor_paso      : %.1f ns por paso\n", (now_ns() - t0) / PASOS);
+
+	volatile unsigned suma = 0;
+	t0 = now_ns();
+	for (unsigned long i = 0; i < PASOS / 100; ++i)
+		for (unsigned j = 0; j < TAREAS; ++j)
+			suma += completo(pila[j]);
+	printf("recorrido entero  : %.1f ns por tarea\n",
+	       (now_ns() - t0) / (PASOS / 100 * TAREAS));
+	return mal;
+}
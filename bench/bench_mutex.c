@@ -0,0 +1,234 @@
+/*
+ * Benchmark en el host de mutex_rapido.h frente al mutex del kernel.
+ *
+ * 1. banco_mutex.c, lo mismo que mide el target con BANCO_MUTEX = 1:
+ *    tomar y dar sin disputa, y una vuelta con disputa (la rival se
+ *    bloquea, hereda y recibe el mutex).
+ * 2. Comprobaciones del camino lento con una tarea que espera: espera
+ *    agotada, herencia y su vuelta atrás, entrega directa, y la herencia
+ *    compartida con un mutex del kernel (uxMutexesHeld). Con techo: la
+ *    subida inmediata, que nadie se adelanta, y la vuelta a la prioridad
+ *    previa con otro mutex tomado.
+ *
+ * Corre el kernel de verdad sobre el puerto del host, compilado aparte sin
+ * los interruptores de la aplicación. En el host el CAS es leer, comparar
+ * y escribir (ver mutex_rapido_cas()) en lugar de LDREX/STREX.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "banco_mutex.h"
+#include "mutex_rapido.h"
+
+#define PRIO_BASE	PRIORIDAD_BANCO_MUTEX
+#define PRIO_ESPERA	(PRIORIDAD_BANCO_MUTEX + 1)
+#define PRIO_TECHO_ALTO	(PRIORIDAD_BANCO_MUTEX + 2)
+
+static volatile int fin;
+
+void vApplicationTickHook(void)
+{
+	if (fin)
+		vTaskEndScheduler();
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t pxTask, char *pcTaskName)
+{
+	(void)pxTask;
+	fprintf(stderr, "Desbordamiento de pila en la tarea %s\n", pcTaskName);
+	abort();
+}
+
+/* --- Comprobaciones ---------------------------------------------------- */
+
+static struct mutex_rapido m;
+static struct mutex_rapido techo;		// Techo PRIO_ESPERA
+static struct mutex_rapido techo_alto;		// Techo PRIO_TECHO_ALTO
+static SemaphoreHandle_t k;
+
+/* Lo que hace vTaskEspera cada vez que la despiertan */
+static volatile enum {
+	ESPERA_NADA,			// tomar m sin espera
+	ESPERA_CORTA,			// tomar m con 3 ticks de espera
+	ESPERA_LARGA,			// tomar m, mirar quién es el dueño, darlo
+	ESPERA_KERNEL,			// tomar k y darlo
+	ESPERA_TECHO,			// tomar techo y darlo
+} accion;
+static volatile BaseType_t resultado;
+static volatile uintptr_t visto;
+static TaskHandle_t espera;
+
+static void vTaskEspera(void *args)
+{
+	(void)args;
+
+	for (;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		switch (accion) {
+		case ESPERA_NADA:
+			resultado = mutex_rapido_tomar(&m, 0);
+			break;
+		case ESPERA_CORTA:
+			resultado = mutex_rapido_tomar(&m, 3);
+			break;
+		case ESPERA_LARGA:
+			resultado = mutex_rapido_tomar(&m, portMAX_DELAY);
+			visto = m.estado;
+			mutex_rapido_dar(&m);
+			break;
+		case ESPERA_KERNEL:
+			resultado = xSemaphoreTake(k, portMAX_DELAY);
+			xSemaphoreGive(k);
+			break;
+		case ESPERA_TECHO:
+			resultado = mutex_rapido_tomar(&techo, 0);
+			mutex_rapido_dar(&techo);
+			break;
+		}
+	}
+}
+
+#define COMPROBACIONES	20
+
+static struct {
+	const char *que;
+	int bien;
+} comprobacion[COMPROBACIONES];
+static unsigned ncomprobaciones;
+
+static void comprobar(const char *que, int bien)
+{
+	if (ncomprobaciones < COMPROBACIONES)
+		comprobacion[ncomprobaciones++] = (typeof(comprobacion[0])){ que, bien };
+}
+
+/* Despierta a vTaskEspera, que corre en seguida (tiene más prioridad) */
+static void __esperar(int a)
+{
+	accion = a;
+	resultado = -1;
+	xTaskNotifyGive(espera);
+}
+
+static void vTaskComprobar(void *args)
+{
+	(void)args;
+
+	while (!banco_mutex.hecho)
+		vTaskDelay(1);
+
+	mutex_rapido_init(&m);
+	mutex_rapido_init_techo(&techo, PRIO_ESPERA);
+	mutex_rapido_init_techo(&techo_alto, PRIO_TECHO_ALTO);
+	k = xSemaphoreCreateMutex();
+	xTaskCreate(vTaskEspera, "Espera", configMINIMAL_STACK_SIZE, NULL,
+		    PRIO_ESPERA, &espera);
+
+	/* Espera agotada: la herencia dura hasta darlo */
+	comprobar("libre: se toma sin esperar", mutex_rapido_tomar(&m, 0) == pdTRUE);
+	__esperar(ESPERA_NADA);
+	comprobar("ocupado y sin espera: no, ni hereda",
+		  resultado == pdFALSE && uxTaskPriorityGet(NULL) == PRIO_BASE);
+	__esperar(ESPERA_CORTA);
+	comprobar("el dueño hereda la prioridad de la que espera",
+		  uxTaskPriorityGet(NULL) == PRIO_ESPERA);
+	vTaskDelay(6);
+	comprobar("espera agotada a los 3 ticks", resultado == pdFALSE);
+	mutex_rapido_dar(&m);
+	comprobar("al darlo: prioridad de vuelta y libre",
+		  uxTaskPriorityGet(NULL) == PRIO_BASE && m.estado == 0);
+
+	/* Entrega directa */
+	mutex_rapido_tomar(&m, 0);
+	__esperar(ESPERA_LARGA);
+	mutex_rapido_dar(&m);
+	comprobar("al darlo pasa a la que espera, sin quedar libre",
+		  resultado == pdTRUE && visto == (uintptr_t)espera);
+	comprobar("ella lo da por el camino rápido: libre",
+		  m.estado == 0 && uxTaskPriorityGet(NULL) == PRIO_BASE);
+
+	/* La herencia del rápido sigue mientras se tenga aunque se dé otro */
+	mutex_rapido_tomar(&m, 0);
+	xSemaphoreTake(k, 0);
+	__esperar(ESPERA_LARGA);
+	xSemaphoreGive(k);
+	comprobar("heredada por el rápido: dar el del kernel no la quita",
+		  uxTaskPriorityGet(NULL) == PRIO_ESPERA);
+	mutex_rapido_dar(&m);
+	comprobar("dar el rápido sí", uxTaskPriorityGet(NULL) == PRIO_BASE &&
+		  resultado == pdTRUE);
+
+	/* Y al revés: heredada por el del kernel, se deshace al dar el
+	 * rápido si es el último (vTaskDecrementMutexHeldCount) */
+	mutex_rapido_tomar(&m, 0);
+	xSemaphoreTake(k, 0);
+	__esperar(ESPERA_KERNEL);
+	xSemaphoreGive(k);
+	comprobar("heredada por el del kernel: sigue con el rápido tomado",
+		  uxTaskPriorityGet(NULL) == PRIO_ESPERA);
+	mutex_rapido_dar(&m);
+	comprobar("dar el rápido, el último, la deshace",
+		  uxTaskPriorityGet(NULL) == PRIO_BASE && resultado == pdTRUE &&
+		  m.estado == 0);
+
+	/* Techo: sube al tomarlo, y la otra no puede ni intentarlo */
+	mutex_rapido_tomar(&techo, 0);
+	comprobar("con techo: sube al tomarlo", uxTaskPriorityGet(NULL) == PRIO_ESPERA);
+	__esperar(ESPERA_TECHO);
+	comprobar("la que lo usa no se adelanta al dueño", resultado == -1);
+	mutex_rapido_dar(&techo);
+	comprobar("al darlo baja, y ella corre y lo toma libre",
+		  uxTaskPriorityGet(NULL) == PRIO_BASE && resultado == pdTRUE &&
+		  techo.estado == 0);
+
+	/* Techo dentro de otro mutex: vuelve a la prioridad de antes */
+	mutex_rapido_tomar(&m, 0);
+	__esperar(ESPERA_LARGA);
+	mutex_rapido_tomar(&techo_alto, 0);
+	comprobar("heredada y con techo más alto: el techo",
+		  uxTaskPriorityGet(NULL) == PRIO_TECHO_ALTO);
+	mutex_rapido_dar(&techo_alto);
+	comprobar("al dar el del techo: la heredada, que sigue haciendo falta",
+		  uxTaskPriorityGet(NULL) == PRIO_ESPERA);
+	mutex_rapido_dar(&m);
+	comprobar("al dar el otro: la base", uxTaskPriorityGet(NULL) == PRIO_BASE &&
+		  resultado == pdTRUE);
+
+	fin = 1;
+	for (;;)
+		vTaskDelay(portMAX_DELAY);
+}
+
+int main(void)
+{
+	xTaskCreate(vTaskBancoMutex, "BancoMutex", configMINIMAL_STACK_SIZE,
+		    NULL, PRIORIDAD_BANCO_MUTEX, NULL);
+	xTaskCreate(vTaskComprobar, "Comprobar", configMINIMAL_STACK_SIZE,
+		    NULL, PRIO_BASE, NULL);
+
+	/* Vuelve cuando el tick hook llama a vTaskEndScheduler() */
+	vTaskStartScheduler();
+
+	printf("ciclos del TSC (libre: por tomar + dar; disputado: por vuelta, "
+	       "dos cambios de contexto)\n");
+	printf("%-18s %8s %11s\n", "", "libre", "disputado");
+	for (unsigned t = 0; t < BANCO_MUTEX_TIPOS; ++t)
+		printf("%-18s %8lu %11lu\n", banco_mutex_nombre[t],
+		       (unsigned long)banco_mutex.libre[t],
+		       (unsigned long)banco_mutex.disputado[t]);
+	printf("vueltas disputadas sin herencia: %lu\n\n",
+	       (unsigned long)banco_mutex.herencia_mal);
+
+	int mal = banco_mutex.herencia_mal != 0;
+	printf("comprobaciones\n");
+	for (unsigned i = 0; i < ncomprobaciones; ++i) {
+		printf("  %-56s %s\n", comprobacion[i].que,
+		       comprobacion[i].bien ? "ok" : "MAL");
+		mal |= !comprobacion[i].bien;
+	}
+	return mal;
+}
@@ -0,0 +1,163 @@
+/*
+ * Benchmark en el host del PID en punto fijo (pid.c).
+ *
+ * 1. Coste por paso: ns y ciclos (TSC en x86) de pid_step() con medidas
+ *    variables. pid.c se compila aparte, así que cada paso es una llamada
+ *    real, como en vTaskControlPWM.
+ * 2. Anti-windup: planta de primer orden que no alcanza el setpoint
+ *    (salida saturada), y luego un setpoint alcanzable. Compara cuánto
+ *    tarda en volver y cuánto se pasa con kaw = 0 (sólo el límite del
+ *    integrador) y con back-calculation (kaw = 1, Tt = T).
+ * 3. Cambio de ganancias en pleno transitorio: salto de la salida con
+ *    pid_set_gains() frente a sustituir las ganancias sin compensar.
+ *
+ * Los ciclos en el Cortex-M3 no se pueden medir aquí: el paso son 3
+ * SMULL/SMLAL más sumas, comparaciones y desplazamientos, sin UDIV.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "pid.h"
+
+#define PASOS		20000000
+#define N_MEDIDAS	4096
+#define OUT_MAX		4095
+
+/* Planta: y += (0.8 * u - y) * T / tau, con T = 3.2ms y tau = 20ms */
+#define PLANTA_GANANCIA	0.8
+#define PLANTA_ALPHA	0.16
+
+static const struct pid_gains gains = {
+	.kp = PID_Q16(0.5),
+	.ki = PID_Q16(0.08),
+	.kd = PID_Q16(0.5),
+	.kaw = PID_Q16(0.16),
+	.d_shift = 2,
+};
+
+static double now_ns(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+static void bench_step(void)
+{
+	static int32_t meas[N_MEDIDAS];
+	struct pid pid;
+	int32_t acc = 0;
+
+	srand(1);
+	for (int i = 0; i < N_MEDIDAS; ++i)
+		meas[i] = rand() % (OUT_MAX + 1);
+
+	pid_init(&pid, &gains, 0, OUT_MAX);
+	pid_reset(&pid, meas[0], 2048);
+
+	double t0 = now_ns();
+#ifdef HAVE_TSC
+	uint64_t c0 = __rdtsc();
+#endif
+	for (int i = 0; i < PASOS; ++i)
+		acc += pid_step(&pid, 2482, meas[i & (N_MEDIDAS - 1)]);
+#ifdef HAVE_TSC
+	uint64_t c1 = __rdtsc();
+#endif
+	double ns = (now_ns() - t0) / PASOS;
+
+	printf("pid_step          : %6.2f ns/paso", ns);
+#ifdef HAVE_TSC
+	printf(", %.1f ciclos TSC/paso", (double)(c1 - c0) / PASOS);
+#endif
+	printf(" (%.1f Mpasos/s)\n", 1e3 / ns);
+	if (acc == 0x5a5a5a5a)	// Evita que se elimine el cálculo
+		printf("\n");
+}
+
+/* Setpoint inalcanzable durante 300 pasos y luego 'sp'. Devuelve los
+ * pasos hasta quedar dentro de ±1% de 'sp' y el sobrepico máximo. */
+static void windup_case(int32_t kaw, int *pasos, double *sobrepico)
+{
+	struct pid_gains g = gains;
+	struct pid pid;
+	double y = 0.0;
+	const int32_t sp = 2000;
+
+	g.kaw = kaw;
+	pid_init(&pid, &g, 0, OUT_MAX);
+	pid_reset(&pid, 0, 0);
+
+	for (int i = 0; i < 300; ++i) {
+		int32_t u = pid_step(&pid, 4000, (int32_t)y);
+		y += (PLANTA_GANANCIA * u - y) * PLANTA_ALPHA;
+	}
+
+	*pasos = -1;
+	*sobrepico = 0.0;
+	for (int i = 0; i < 2000; ++i) {
+		int32_t u = pid_step(&pid, sp, (int32_t)y);
+		y += (PLANTA_GANANCIA * u - y) * PLANTA_ALPHA;
+		if (sp - y > *sobrepico)
+			*sobrepico = sp - y;
+		if (y > sp * 0.99 && y < sp * 1.01) {
+			if (*pasos < 0)
+				*pasos = i + 1;
+		} else {
+			*pasos = -1;
+		}
+	}
+}
+
+/* Salto de la salida al triplicar kp y kd a mitad de un transitorio */
+static int32_t bump_case(int bumpless)
+{
+	struct pid_gains g2 = gains;
+	struct pid pid;
+	double y = 0.0;
+	int32_t u = 0, u_prev = 0;
+
+	g2.kp *= 3;
+	g2.kd *= 3;
+	pid_init(&pid, &gains, 0, OUT_MAX);
+	pid_reset(&pid, 0, 0);
+
+	for (int i = 0; i < 12; ++i) {
+		u_prev = u;
+		u = pid_step(&pid, 1500, (int32_t)y);
+		y += (PLANTA_GANANCIA * u - y) * PLANTA_ALPHA;
+	}
+
+	if (bumpless)
+		pid_set_gains(&pid, &g2);
+	else
+		pid.g = g2;
+
+	/* Medida repetida: sin salto, la salida sigue la tendencia previa */
+	int32_t u_next = pid_step(&pid, 1500, (int32_t)y);
+	return abs((u_next - u) - (u - u_prev));
+}
+
+int main(void)
+{
+	int p0, p1;
+	double s0, s1;
+
+	bench_step();
+
+	windup_case(0, &p0, &s0);
+	windup_case(PID_Q16(1.0), &p1, &s1);
+	printf("tras saturar      : kaw=0 %d pasos (sobrepico %.0f), "
+	       "back-calculation %d pasos (sobrepico %.0f)\n", p0, s0, p1, s1);
+
+	printf("cambio de kp,kd   : salto %ld cuentas sin compensar, "
+	       "%ld con pid_set_gains()\n",
+	       (long)bump_case(0), (long)bump_case(1));
+	return 0;
+}
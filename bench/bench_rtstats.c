@@ -0,0 +1,89 @@
+/*
+ * Benchmark en el host de las estadísticas por tarea (rtstats.c).
+ *
+ * 1. Coste de rtstats_switch_in(), lo que se añade a cada cambio de
+ *    contexto: lectura del contador de ciclos y contabilidad, rotando
+ *    entre 4 tareas como en la aplicación (con cierres de subventana).
+ * 2. Coste de rtstats_volcar() con 5 huecos, desde una tarea.
+ * 3. Coherencia: la suma de los totales es el tiempo transcurrido y la
+ *    suma de las cargas en la ventana es el 100%.
+ * 4. Ventana deslizante: con tiempos sintéticos, una tarea toda una
+ *    ventana y otra media después; la carga es mitad y mitad.
+ *
+ * Se enlaza con rtstats.c compilado con RTSTATS = 1 y sin kernel: las
+ * secciones críticas son vacías.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "rtstats.h"
+
+#define CAMBIOS		(32UL * 1000000UL)
+#define VOLCADOS	1000000UL
+
+void vPortEnterCritical(void) {}
+void vPortExitCritical(void) {}
+
+static double now_ns(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+int main(void)
+{
+	static const char *nombres[] = { "(otros)", "LED", "ADC", "PWM_Ctrl", "IDLE" };
+	static const unsigned orden[] = { 2, 3, 2, 4, 2, 1, 2, 4 };
+
+	for (unsigned i = 1; i < 5; ++i)
+		rtstats_creada((void *)nombres[i], i);
+	rtstats_init();
+
+	uint32_t c0 = ciclos_leer();
+	double t0 = now_ns();
+	for (unsigned long i = 0; i < CAMBIOS; ++i)
+		rtstats_switch_in(orden[i & 7]);
+	double ns = (now_ns() - t0) / CAMBIOS;
+
+	struct rtstats_info info[5];
+	rtstats_leer(info, 5);
+	uint32_t transcurrido = ciclos_leer() - c0;
+
+	printf("rtstats_switch_in : %.2f ns por cambio de contexto (%lu subventanas)\n",
+	       ns, (unsigned long)rtstats.subventanas);
+
+	uint64_t suma = 0;
+	uint32_t carga = 0;
+	for (unsigned i = 0; i < 5; ++i) {
+		suma += info[i].total;
+		carga += info[i].carga;
+	}
+	printf("coherencia        : totales %llu de %lu ciclos, cargas %.2f%%\n",
+	       (unsigned long long)suma, (unsigned long)transcurrido, carga / 100.0);
+
+	uint8_t buf[RTSTATS_VOLCADO_MAX];
+	size_t bytes = 0;
+	t0 = now_ns();
+	for (unsigned long i = 0; i < VOLCADOS; ++i)
+		bytes += rtstats_volcar(buf, sizeof(buf));
+	printf("rtstats_volcar    : %.1f ns, %lu bytes\n",
+	       (now_ns() - t0) / VOLCADOS, (unsigned long)(bytes / VOLCADOS));
+
+	/* Acaba justo antes de ahora: rtstats_leer() cuenta hasta ciclos_leer() */
+	const uint32_t paso = RTSTATS_SUBVENTANA_CICLOS / 4;
+	rtstats_init();
+	uint32_t t = ciclos_leer() - 12 * RTSTATS_SUBVENTANA_CICLOS;
+	rtstats.t_cambio = rtstats.t_rafaga = rtstats.t_sub = t;
+	rtstats_contar(t, 1);
+	for (unsigned i = 0; i < 4 * RTSTATS_SUBVENTANAS; ++i)
+		rtstats_contar(t += paso, 1);
+	rtstats_contar(t, 2);
+	for (unsigned i = 0; i < 2 * RTSTATS_SUBVENTANAS; ++i)
+		rtstats_contar(t += paso, 2);
+	rtstats_leer(info, 5);
+	int mal = info[1].carga != 5000 || info[2].carga != 5000;
+	printf("ventana deslizante: %.2f%% / %.2f%% (50 / 50)  %s\n",
+	       info[1].carga / 100.0, info[2].carga / 100.0, mal ? "MAL" : "ok");
+	return mal;
+}
@@ -0,0 +1,119 @@
+/*
+ * Benchmark en el host del generador de barridos (sweep.c).
+ *
+ * 1. Exactitud: genera barridos completos período a período y compara
+ *    con la ley ideal en double, evaluada en el instante exacto (en
+ *    cuentas del timer) en que empieza cada período:
+ *	- ley: error relativo de la frecuencia que lleva el generador
+ *	  (punto fijo e integración por períodos), sin redondear a ARR;
+ *	- salida: error relativo de la frecuencia que sale de verdad,
+ *	  (reloj / (PSC + 1)) / (ARR + 1), que añade el redondeo a cuentas;
+ *	- duración: suma de los períodos emitidos frente a la pedida.
+ * 2. Coste de sweep_fill() por período y la carga de CPU equivalente a
+ *    la frecuencia de salida más alta de cada barrido.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "sweep.h"
+
+#define CLOCK_HZ	72000000UL
+#define PERIODOS	(16UL * 1000000UL)
+
+static double now_ns(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+static double ideal(const struct sweep_config *c, double x)
+{
+	double f0 = c->f_inicio_hz, f1 = c->f_fin_hz;
+
+	if (c->ley == SWEEP_LOG)
+		return f0 * pow(f1 / f0, x);
+	return f0 + (f1 - f0) * x;
+}
+
+static void exactitud(const struct sweep_config *c)
+{
+	struct sweep sw;
+	uint16_t p[SWEEP_PALABRAS];
+
+	if (sweep_init(&sw, c, CLOCK_HZ) != 0) {
+		printf("%7lu %7lu %-6s %6lu  no realizable\n",
+		       (unsigned long)c->f_inicio_hz, (unsigned long)c->f_fin_hz,
+		       c->ley == SWEEP_LOG ? "log" : "lineal",
+		       (unsigned long)c->duracion_ms);
+		return;
+	}
+
+	const double fclk = (double)CLOCK_HZ / (sw.psc + 1);
+	const double T = (double)sw.t_fin;
+	double err_ley = 0.0, err_sal = 0.0;
+	uint64_t t = 0, n = 0;
+
+	while (!sw.terminado) {
+		double f_gen = (double)(sw.f >> 32) / (double)(1ULL << sw.s);
+		double f_id = ideal(c, (double)t / T);
+
+		sweep_fill(&sw, p, 1);
+
+		double f_sal = fclk / (p[0] + 1.0);
+		double e = fabs(f_gen - f_id) / f_id;
+		if (e > err_ley) err_ley = e;
+		e = fabs(f_sal - f_id) / f_id;
+		if (e > err_sal) err_sal = e;
+
+		t += p[0] + 1U;
+		n++;
+	}
+
+	printf("%7lu %7lu %-6s %6lu %4lu %9llu  %8.1e  %8.1e  %+6lld (%.2f us)\n",
+	       (unsigned long)c->f_inicio_hz, (unsigned long)c->f_fin_hz,
+	       c->ley == SWEEP_LOG ? "log" : "lineal",
+	       (unsigned long)c->duracion_ms, (unsigned long)sw.psc,
+	       (unsigned long long)n, err_ley, err_sal,
+	       (long long)(t - sw.t_fin), (double)(t - sw.t_fin) * 1e6 / fclk);
+}
+
+int main(void)
+{
+	static const struct sweep_config barridos[] = {
+		{ 100, 10000, 1000, SWEEP_LINEAL, 32768, 0 },
+		{ 100, 10000, 1000, SWEEP_LOG, 32768, 0 },
+		{ 10000, 100, 1000, SWEEP_LOG, 32768, 0 },
+		{ 20, 20000, 10000, SWEEP_LOG, 32768, 0 },
+		{ 1, 100, 60000, SWEEP_LINEAL, 32768, 0 },
+		{ 1000, 100000, 100, SWEEP_LOG, 32768, 0 },
+		{ 1000, 100000, 10, SWEEP_LOG, 32768, 0 },
+		{ 50000, 1000000, 50, SWEEP_LINEAL, 32768, 0 },
+	};
+
+	printf("     f0      f1 ley        ms  PSC  períodos  err. ley  err. sal.  "
+	       "duración (cuentas)\n");
+	for (unsigned i = 0; i < sizeof(barridos) / sizeof(barridos[0]); ++i)
+		exactitud(&barridos[i]);
+
+	static uint16_t buf[32 * SWEEP_PALABRAS];
+	static const enum sweep_ley leyes[] = { SWEEP_LINEAL, SWEEP_LOG };
+	uint32_t sink = 0;
+
+	for (unsigned l = 0; l < 2; ++l) {
+		struct sweep_config c = { 100, 100000, 1000, leyes[l], 32768, 1 };
+		struct sweep sw;
+
+		sweep_init(&sw, &c, CLOCK_HZ);
+		double t0 = now_ns();
+		for (unsigned long i = 0; i < PERIODOS / 32; ++i) {
+			sweep_fill(&sw, buf, 32);
+			sink += buf[i & 31];
+		}
+		double ns = (now_ns() - t0) / PERIODOS;
+		printf("sweep_fill %-6s: %.2f ns/período, %.2f%% de CPU a 100 kHz\n",
+		       l ? "log" : "lineal", ns, ns * 100000 * 1e-7);
+	}
+	return sink == 0x5a5a5a5a;	// Evita que se elimine el cálculo
+}
@@ -0,0 +1,106 @@
+/*
+ * Una implementación de rtos/heap_N.c (N = HEAP_N) con sus funciones
+ * renombradas a heapN_*, para tener las cinco en el mismo programa
+ * (bench_heap.c), más el tamaño del mayor bloque libre, que sale de
+ * recorrer su lista interna.
+ */
+#include <stddef.h>
+
+#define __PEGAR(a, b, c)	a##b##c
+#define __NOMBRE(n, f)		__PEGAR(heap, n, f)
+#define HEAP_FN(f)		__NOMBRE(HEAP_N, f)
+
+#define pvPortMalloc			HEAP_FN(_malloc)
+#define vPortFree			HEAP_FN(_free)
+#define xPortGetFreeHeapSize		HEAP_FN(_libre)
+#define xPortGetMinimumEverFreeHeapSize	HEAP_FN(_libre_min)
+#define vPortInitialiseBlocks		HEAP_FN(_init_bloques)
+#define vPortDefineHeapRegions		HEAP_FN(_regiones)
+
+#if HEAP_N == 1
+#include "heap_1.c"
+#elif HEAP_N == 2
+#include "heap_2.c"
+#elif HEAP_N == 3
+#include "heap_3.c"
+#elif HEAP_N == 4
+#include "heap_4.c"
+#elif HEAP_N == 5
+#include "heap_5.c"
+#endif
+
+#include "bench_heap.h"
+
+#if HEAP_N == 1
+/* Sin lista: lo libre es contiguo */
+static size_t __mayor(void)
+{
+	return xPortGetFreeHeapSize();
+}
+#elif HEAP_N == 3
+/* malloc() del sistema: sin límite ni datos */
+size_t xPortGetFreeHeapSize(void)
+{
+	return 0;
+}
+
+static size_t __mayor(void)
+{
+	return 0;
+}
+#else
+static size_t __mayor(void)
+{
+	size_t mayor = 0;
+
+	/* Sin inicializar: aún no se pidió nada */
+	if (xStart.pxNextFreeBlock == NULL)
+		return xPortGetFreeHeapSize();
+
+	for (BlockLink_t *b = xStart.pxNextFreeBlock; b != NULL; b = b->pxNextFreeBlock) {
+#if HEAP_N == 2
+		if (b == &xEnd)
+			break;
+#endif
+		if (b->xBlockSize > mayor)
+			mayor = b->xBlockSize;
+	}
+#if HEAP_N == 2
+	const size_t cabecera = heapSTRUCT_SIZE;
+#else
+	const size_t cabecera = xHeapStructSize;
+#endif
+	return mayor > cabecera ? mayor - cabecera : 0;
+}
+#endif
+
+#if HEAP_N == 5
+/* Una región del mismo tamaño que el heap de los demás */
+static uint8_t region[configTOTAL_HEAP_SIZE];
+
+static void __init(void)
+{
+	static int hecho;
+	const HeapRegion_t r[] = { { region, sizeof(region) }, { NULL, 0 } };
+
+	if (!hecho) {
+		vPortDefineHeapRegions(r);
+		hecho = 1;
+	}
+}
+#else
+static void __init(void)
+{
+}
+#endif
+
+const struct heap_banco HEAP_FN() = {
+	.nombre = HEAP_N == 1 ? "heap_1" : HEAP_N == 2 ? "heap_2" :
+		  HEAP_N == 3 ? "heap_3" : HEAP_N == 4 ? "heap_4" : "heap_5",
+	.libera = HEAP_N != 1,
+	.init = __init,
+	.tomar = pvPortMalloc,
+	.soltar = vPortFree,
+	.libre = xPortGetFreeHeapSize,
+	.mayor = __mayor,
+};
@@ -0,0 +1,49 @@
+#ifndef CICLOS_H
+#define CICLOS_H
+
+#include <stdint.h>
+
+/*
+ * Contador de ciclos de 32 bits para medir tiempos (rtstats.h, traza.h).
+ *
+ * Target: DWT_CYCCNT del Cortex-M3, a configCPU_CLOCK_HZ (72 MHz, da la
+ * vuelta cada ~59 s). Host: el TSC (x86) o CLOCK_MONOTONIC en ns. Las
+ * diferencias entre dos lecturas son válidas mientras no pase una vuelta
+ * entera.
+ */
+
+#ifdef HOST_PORT
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint32_t ciclos_leer(void)
+{
+	return (uint32_t)__rdtsc();
+}
+#else
+#include <time.h>
+static inline uint32_t ciclos_leer(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint32_t)(t.tv_sec * 1000000000ULL + t.tv_nsec);
+}
+#endif
+
+static inline void ciclos_init(void)
+{
+}
+#else
+#include <libopencm3/cm3/dwt.h>
+static inline uint32_t ciclos_leer(void)
+{
+	return DWT_CYCCNT;
+}
+
+/* DEMCR.TRCENA y DWT_CTRL.CYCCNTENA */
+static inline void ciclos_init(void)
+{
+	dwt_enable_cycle_counter();
+}
+#endif
+
+#endif // CICLOS_H
@@ -0,0 +1,72 @@
+#ifndef COLA_TIPADA_H
+#define COLA_TIPADA_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/*
+ * Cola del kernel con el tipo del elemento fijo en compilación.
+ *
+ * COLA_TIPADA(nombre, tipo, largo) define la cola 'nombre' de 'largo'
+ * elementos de 'tipo' y sus funciones:
+ *
+ *   nombre_crear()                        la crea (una vez, antes de usarla)
+ *   nombre_enviar(const tipo *, espera)   xQueueSend()
+ *   nombre_recibir(tipo *, espera)        xQueueReceive()
+ *   nombre_enviar_isr(const tipo *, &w)   xQueueSendFromISR()
+ *   nombre_recibir_isr(tipo *, &w)        xQueueReceiveFromISR()
+ *
+ * El tamaño del elemento es sizeof(tipo) y el compilador comprueba los
+ * punteros: no se puede enviar un uint16_t a una cola de uint32_t. Con
+ * elementos de 2, 4 u 8 bytes la cola usa la copia especializada de
+ * queue.c (configQUEUE_SMALL_ITEM_COPY), sin memcpy() de la libc.
+ *
+ * Con configSUPPORT_STATIC_ALLOCATION la estructura y el almacenamiento
+ * son estáticos (.bss), como en TAREA_CREAR: crear no puede fallar.
+ * 'nombre' es el QueueHandle_t, para lo que no cubren las funciones.
+ */
+
+#if configSUPPORT_STATIC_ALLOCATION
+#define COLA_TIPADA_NUEVA_(nombre, tipo, largo) do {			\
+		static StaticQueue_t cola_;				\
+		static uint8_t mem_[(largo) * sizeof(tipo)];		\
+		nombre = xQueueCreateStatic((largo), sizeof(tipo), mem_, &cola_); \
+	} while (0)
+#else
+#define COLA_TIPADA_NUEVA_(nombre, tipo, largo) \
+	(nombre = xQueueCreate((largo), sizeof(tipo)))
+#endif
+
+#define COLA_TIPADA(nombre, tipo, largo)					\
+	static QueueHandle_t nombre;						\
+									\
+	static inline QueueHandle_t nombre##_crear(void)			\
+	{									\
+		COLA_TIPADA_NUEVA_(nombre, tipo, largo);			\
+		return nombre;							\
+	}									\
+									\
+	static inline BaseType_t nombre##_enviar(const tipo *v,		\
+						  TickType_t espera)		\
+	{									\
+		return xQueueSend(nombre, v, espera);				\
+	}									\
+									\
+	static inline BaseType_t nombre##_recibir(tipo *v, TickType_t espera)	\
+	{									\
+		return xQueueReceive(nombre, v, espera);			\
+	}									\
+									\
+	static inline BaseType_t nombre##_enviar_isr(const tipo *v,		\
+						      BaseType_t *w)		\
+	{									\
+		return xQueueSendFromISR(nombre, v, w);				\
+	}									\
+									\
+	static inline BaseType_t nombre##_recibir_isr(tipo *v, BaseType_t *w)	\
+	{									\
+		return xQueueReceiveFromISR(nombre, v, w);			\
+	}									\
+	typedef tipo nombre##_tipo_t
+
+#endif // COLA_TIPADA_H
@@ -3,15 +3,27 @@
 #include <libopencm3/stm32/adc.h>   // <-- AÑADIDO
 #include <libopencm3/stm32/dma.h>   // <-- AÑADIDO
 #include <libopencm3/stm32/timer.h> // Para timer_reset() y otrascle
+#include <libopencm3/cm3/nvic.h>
 #include "config.h"
+#include "hal.h"
 
 /*
  * Búfer de destino para el DMA.
  * El DMA (hardware) escribirá aquí. La tarea (software) leerá desde aquí.
  * 'volatile' es crucial. 'extern' significa que está definido en otro
- * archivo (en nuestro caso, tasks.c).
+ * archivo (en nuestro caso, hal_opencm3.c).
  */
-extern volatile uint16_t adc_dma_buffer[2];
+extern volatile uint16_t adc_dma_buffer[HAL_ADC_DMA_LEN];
+
+#if HAL_PWM_DITHER
+/* Patrón de CCR1 del dithering (definido en hal_opencm3.c). */
+extern volatile uint16_t pwm_dither_buffer[HAL_PWM_DITHER_LEN];
+#endif
+
+#if HAL_PWM_DDS
+/* Muestras del DDS (definido en hal_opencm3.c). */
+extern volatile uint16_t pwm_dds_buffer[2 * HAL_DDS_HALF_LEN];
+#endif
 
 
 /**
@@ -40,8 +52,59 @@ void gpio_setup(void)
 		      GPIO_CNF_INPUT_ANALOG, GPIO0 | GPIO1);
 }
 
+#if HAL_ADC_TIMER_TRIGGER
+
+/*
+ * TIM3 como base de tiempos del ADC.
+ * Reloj del TIM3 = 2 x APB1 = 72MHz (APB1 = 36MHz con prescaler /2).
+ * Un evento de actualización (TRGO) por secuencia: PSC y ARR se eligen
+ * al compilar para que (PSC + 1) * (ARR + 1) = 72MHz / ritmo, exacto.
+ */
+#define ADC_TRIG_CLOCK_HZ	72000000UL
+#define ADC_TRIG_TICKS		(ADC_TRIG_CLOCK_HZ / HAL_ADC_SAMPLE_RATE_HZ)
+#define ADC_TRIG_PSC		((ADC_TRIG_TICKS - 1) / 65536UL)
+#define ADC_TRIG_ARR		(ADC_TRIG_TICKS / (ADC_TRIG_PSC + 1) - 1)
+
+_Static_assert(ADC_TRIG_CLOCK_HZ % HAL_ADC_SAMPLE_RATE_HZ == 0 &&
+	       (ADC_TRIG_PSC + 1) * (ADC_TRIG_ARR + 1) == ADC_TRIG_TICKS,
+	       "HAL_ADC_SAMPLE_RATE_HZ no se puede generar exactamente con TIM3");
+
+/*
+ * Con disparo por timer sobra tiempo entre secuencias, así que se usa el
+ * muestreo más largo (mejor precisión con fuentes de alta impedancia):
+ * 2 x (239.5 + 12.5) ciclos de 12MHz = 42us por secuencia.
+ */
+#define ADC_SMPR_TIME		ADC_SMPR_SMP_239DOT5CYC
+_Static_assert(HAL_ADC_SAMPLE_RATE_HZ <= 12000000UL / (2UL * 252UL),
+	       "HAL_ADC_SAMPLE_RATE_HZ demasiado alto para el tiempo de muestreo");
+
+/**
+ * @brief Configura el TIM3 para disparar el ADC (TRGO en cada actualización).
+ */
+static void adc_trigger_setup(void)
+{
+	rcc_periph_clock_enable(RCC_TIM3);
+
+	timer_reset(TIM3);
+	timer_set_mode(TIM3, TIM_CR1_CKD_CK_INT, TIM_CR1_CMS_EDGE,
+		       TIM_CR1_DIR_UP);
+	timer_set_prescaler(TIM3, ADC_TRIG_PSC);
+	timer_set_period(TIM3, ADC_TRIG_ARR);
+	timer_set_master_mode(TIM3, TIM_CR2_MMS_UPDATE); // TRGO = actualización
+}
+
+#else
+
+#define ADC_SMPR_TIME		ADC_SMPR_SMP_28DOT5CYC
+
+#endif // HAL_ADC_TIMER_TRIGGER
+
 /**
  * @brief Configura el hardware ADC1 y DMA1 (Canal 1) en modo circular.
+ *
+ * El búfer tiene dos mitades de HAL_ADC_BLOCK_PAIRS pares; las
+ * interrupciones de mitad (HT) y final (TC) de transferencia entregan
+ * cada mitad completa a la aplicación (ver hal_opencm3.c).
  */
 void adc_dma_init(void)
 {
@@ -53,20 +116,34 @@ void adc_dma_init(void)
 	dma_channel_reset(DMA1, DMA_CHANNEL1);
 	dma_set_peripheral_address(DMA1, DMA_CHANNEL1, (uint32_t)&ADC_DR(ADC1));
 	dma_set_memory_address(DMA1, DMA_CHANNEL1, (uint32_t)adc_dma_buffer);
-	dma_set_number_of_data(DMA1, DMA_CHANNEL1, 2); // Dos canales (Amp, Freq)
+	dma_set_number_of_data(DMA1, DMA_CHANNEL1, HAL_ADC_DMA_LEN); // Pares (Amp, Freq)
 	dma_set_read_from_peripheral(DMA1, DMA_CHANNEL1);
 	dma_enable_memory_increment_mode(DMA1, DMA_CHANNEL1);
 	dma_enable_circular_mode(DMA1, DMA_CHANNEL1);
 	dma_set_peripheral_size(DMA1, DMA_CHANNEL1, DMA_CCR_PSIZE_16BIT);
 	dma_set_memory_size(DMA1, DMA_CHANNEL1, DMA_CCR_MSIZE_16BIT);
 	dma_set_priority(DMA1, DMA_CHANNEL1, DMA_CCR_PL_HIGH);
+	dma_enable_half_transfer_interrupt(DMA1, DMA_CHANNEL1);
+	dma_enable_transfer_complete_interrupt(DMA1, DMA_CHANNEL1);
+
+	/*
+	 * Prioridad 12 (0xC0): por debajo de configMAX_SYSCALL_INTERRUPT_PRIORITY
+	 * (0xB0), así que la ISR puede usar la API ...FromISR de FreeRTOS.
+	 */
+	nvic_set_priority(NVIC_DMA1_CHANNEL1_IRQ, 0xC0);
+	nvic_enable_irq(NVIC_DMA1_CHANNEL1_IRQ);
 
 	/* 3. Configurar el ADC1 */
 	adc_power_off(ADC1);
 	adc_disable_scan_mode(ADC1);
+#if HAL_ADC_TIMER_TRIGGER
+	adc_set_single_conversion_mode(ADC1); // Una secuencia por disparo
+	adc_enable_external_trigger_regular(ADC1, ADC_CR2_EXTSEL_TIM3_TRGO);
+#else
 	adc_set_continuous_conversion_mode(ADC1); // Modo continuo
+#endif
 	adc_set_right_aligned(ADC1);
-	adc_set_sample_time_on_all_channels(ADC1, ADC_SMPR_SMP_28DOT5CYC);
+	adc_set_sample_time_on_all_channels(ADC1, ADC_SMPR_TIME);
 	adc_enable_scan_mode(ADC1); // Modo Scan para múltiples canales
 	
 	adc_power_on(ADC1);
@@ -83,8 +160,14 @@ void adc_dma_init(void)
 	adc_set_regular_sequence(ADC1, 2, channels);
 
 	/* 4. Conectar ADC con DMA y arrancar */
+	dma_enable_channel(DMA1, DMA_CHANNEL1);
 	adc_enable_dma(ADC1);
+#if HAL_ADC_TIMER_TRIGGER
+	adc_trigger_setup();
+	timer_enable_counter(TIM3); // Primer disparo en 1/HAL_ADC_SAMPLE_RATE_HZ
+#else
 	adc_start_conversion_regular(ADC1);
+#endif
 }
 
 
@@ -119,8 +202,13 @@ void pwm_setup(void)
 	timer_set_prescaler(TIM1, 0); 
 	timer_set_period(TIM1, 7199);
 
+	/* ARR con precarga: un cambio de período entra en el próximo UEV
+	 * (ver hal_pwm_set()) */
+	timer_enable_preload(TIM1);
+
 	/* 5. Configuración del Canal PWM (TIM1_CH1 en PA8) */
 	timer_set_oc_mode(TIM1, TIM_OC1, TIM_OCM_PWM1); // Modo PWM 1
+	timer_enable_oc_preload(TIM1, TIM_OC1);       // CCR1 con precarga
 	timer_enable_oc_output(TIM1, TIM_OC1);        // Habilitar salida del canal 1
 	
 	/* * 6. Configuración del Ciclo de Trabajo (Amplitud)
@@ -135,7 +223,90 @@ void pwm_setup(void)
 	 */
 	timer_set_oc_value(TIM1, TIM_OC1, 3600); // 50% duty cycle inicial
 
-	/* 7. Habilitar el Timer */
+#if HAL_PWM_DITHER
+	/* * 6b. Dithering: en cada UEV el DMA1 Canal 5 (TIM1_UP) copia el
+	 * siguiente valor del patrón circular en CCR1 (precarga), que entra
+	 * en el UEV siguiente. Sin interrupciones: la CPU sólo reescribe el
+	 * patrón cuando cambia el duty (hal_pwm_set_duty()).
+	 */
+	for (unsigned i = 0; i < HAL_PWM_DITHER_LEN; ++i)
+		pwm_dither_buffer[i] = 3600;
+
+	rcc_periph_clock_enable(RCC_DMA1);
+	dma_channel_reset(DMA1, DMA_CHANNEL5);
+	dma_set_peripheral_address(DMA1, DMA_CHANNEL5, (uint32_t)&TIM1_CCR1);
+	dma_set_memory_address(DMA1, DMA_CHANNEL5, (uint32_t)pwm_dither_buffer);
+	dma_set_number_of_data(DMA1, DMA_CHANNEL5, HAL_PWM_DITHER_LEN);
+	dma_set_read_from_memory(DMA1, DMA_CHANNEL5);
+	dma_enable_memory_increment_mode(DMA1, DMA_CHANNEL5);
+	dma_enable_circular_mode(DMA1, DMA_CHANNEL5);
+	dma_set_peripheral_size(DMA1, DMA_CHANNEL5, DMA_CCR_PSIZE_16BIT);
+	dma_set_memory_size(DMA1, DMA_CHANNEL5, DMA_CCR_MSIZE_16BIT);
+	dma_set_priority(DMA1, DMA_CHANNEL5, DMA_CCR_PL_MEDIUM);
+	dma_enable_channel(DMA1, DMA_CHANNEL5);
+	timer_enable_irq(TIM1, TIM_DIER_UDE);	// Petición de DMA en cada UEV
+#endif
+
+#if HAL_PWM_DDS
+	/* * 6c. DDS: período fijo HAL_DDS_PERIOD (la frecuencia de muestreo)
+	 * y un CCR1 por período desde pwm_dds_buffer, por el DMA1 Canal 5
+	 * (TIM1_UP). Las interrupciones HT/TC piden la mitad siguiente.
+	 * Empieza en reposo (50%) hasta que la aplicación fije la salida.
+	 */
+	timer_set_period(TIM1, HAL_DDS_PERIOD - 1);
+	timer_set_oc_value(TIM1, TIM_OC1, HAL_DDS_PERIOD / 2);
+	for (unsigned i = 0; i < 2 * HAL_DDS_HALF_LEN; ++i)
+		pwm_dds_buffer[i] = HAL_DDS_PERIOD / 2;
+
+	rcc_periph_clock_enable(RCC_DMA1);
+	dma_channel_reset(DMA1, DMA_CHANNEL5);
+	dma_set_peripheral_address(DMA1, DMA_CHANNEL5, (uint32_t)&TIM1_CCR1);
+	dma_set_memory_address(DMA1, DMA_CHANNEL5, (uint32_t)pwm_dds_buffer);
+	dma_set_number_of_data(DMA1, DMA_CHANNEL5, 2 * HAL_DDS_HALF_LEN);
+	dma_set_read_from_memory(DMA1, DMA_CHANNEL5);
+	dma_enable_memory_increment_mode(DMA1, DMA_CHANNEL5);
+	dma_enable_circular_mode(DMA1, DMA_CHANNEL5);
+	dma_set_peripheral_size(DMA1, DMA_CHANNEL5, DMA_CCR_PSIZE_16BIT);
+	dma_set_memory_size(DMA1, DMA_CHANNEL5, DMA_CCR_MSIZE_16BIT);
+	dma_set_priority(DMA1, DMA_CHANNEL5, DMA_CCR_PL_VERY_HIGH);
+	dma_enable_half_transfer_interrupt(DMA1, DMA_CHANNEL5);
+	dma_enable_transfer_complete_interrupt(DMA1, DMA_CHANNEL5);
+
+	/* La ISR no usa el kernel: prioridad por encima de
+	 * configMAX_SYSCALL_INTERRUPT_PRIORITY, las secciones críticas del
+	 * RTOS no la retrasan. */
+	nvic_set_priority(NVIC_DMA1_CHANNEL5_IRQ, 0x40);
+	nvic_enable_irq(NVIC_DMA1_CHANNEL5_IRQ);
+
+	dma_enable_channel(DMA1, DMA_CHANNEL5);
+	timer_enable_irq(TIM1, TIM_DIER_UDE);	// Petición de DMA en cada UEV
+#endif
+
+#if HAL_PWM_SWEEP
+	/* * 6d. Barridos: el DMA1 Canal 5 (TIM1_UP) escribe en TIM1_DMAR en
+	 * ráfagas {ARR, RCR, CCR1}. Aquí sólo la parte fija; el búfer, TIM1_DCR
+	 * y la petición UDE los pone hal_pwm_sweep_start() en cada barrido.
+	 */
+	rcc_periph_clock_enable(RCC_DMA1);
+	dma_channel_reset(DMA1, DMA_CHANNEL5);
+	dma_set_read_from_memory(DMA1, DMA_CHANNEL5);
+	dma_enable_memory_increment_mode(DMA1, DMA_CHANNEL5);
+	dma_enable_circular_mode(DMA1, DMA_CHANNEL5);
+	dma_set_peripheral_size(DMA1, DMA_CHANNEL5, DMA_CCR_PSIZE_16BIT);
+	dma_set_memory_size(DMA1, DMA_CHANNEL5, DMA_CCR_MSIZE_16BIT);
+	dma_set_priority(DMA1, DMA_CHANNEL5, DMA_CCR_PL_VERY_HIGH);
+	dma_enable_half_transfer_interrupt(DMA1, DMA_CHANNEL5);
+	dma_enable_transfer_complete_interrupt(DMA1, DMA_CHANNEL5);
+
+	/* Como en el DDS: la ISR no usa el kernel. La habilitan
+	 * hal_pwm_sweep_start() y hal_pwm_sweep_stop() en cada barrido. */
+	nvic_set_priority(NVIC_DMA1_CHANNEL5_IRQ, 0x40);
+#endif
+
+	/* 7. Habilitar el Timer
+	 * Con precarga, ARR/CCR1 sólo llegan a los registros activos con un
+	 * UEV: se fuerza uno (UG) antes de arrancar. */
+	timer_generate_event(TIM1, TIM_EGR_UG);
 	timer_enable_break_main_output(TIM1); // Necesario para TIM1
 	timer_enable_counter(TIM1);
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "control.h"
+#include "fsynth.h"
+
+/*
+ * Mapeo lineal (sin PID) de las entradas a la salida:
+ *
+ *	Frecuencia: si 2.0V -> 10,000 Hz	f(V) = (V / 2.0V) * 10,000 Hz
+ *	Amplitud:   si 2.0V -> 60.6% Duty	d(V) = (V / 2.0V) * 60.6%
+ *
+ *	(PSC + 1) * (ARR + 1) = 72,000,000 / Frecuencia	(fsynth_solve)
+ *	CCR = (ARR + 1) * Duty_Cycle_Percent
+ */
+
+
+/* ========= Versión float (original) ========= */
+
+static inline float __u12_to_volts(uint16_t raw)
+{
+	/* ADC de 12 bits: 0..4095 */
+	return (3.3f * (float)raw) / 4095.0f;
+}
+
+void control_map_float(uint16_t amp_raw, uint16_t freq_raw,
+		       struct control_output *out)
+{
+	/* * Constantes para la conversión.
+	 * (Setpoint Voltaje = 2.0V)
+	 * (Setpoint Freq = 10000 Hz)
+	 * (Setpoint Amplitud Vpp = 2.0V) -> Duty Cycle = 2.0/3.3 = 60.6%
+	 */
+	const float SETPOINT_VOLTS = 2.0f;
+	const float TARGET_FREQ_HZ = 10000.0f;
+	const float TARGET_DUTY_PCT = 2.0f / 3.3f; // 60.6%
+	const uint32_t TIM_CLOCK_HZ = CONTROL_TIM_CLOCK_HZ;
+
+	float fAmplitudVolts = __u12_to_volts(amp_raw);
+	float fFrecuenciaVolts = __u12_to_volts(freq_raw);
+
+	float nueva_frec_hz = (fFrecuenciaVolts / SETPOINT_VOLTS) * TARGET_FREQ_HZ;
+
+	/* Asegura que la frecuencia no sea cero (evita división por cero) */
+	if (nueva_frec_hz < 100.0f) { // Límite inferior de 100Hz
+		nueva_frec_hz = 100.0f;
+	}
+
+	float nuevo_duty_pct = (fAmplitudVolts / SETPOINT_VOLTS) * TARGET_DUTY_PCT;
+
+	/* Limita el duty cycle entre 0% y 100% */
+	if (nuevo_duty_pct > 1.0f) nuevo_duty_pct = 1.0f;
+	if (nuevo_duty_pct < 0.0f) nuevo_duty_pct = 0.0f;
+
+	/* Período en ciclos (Q28.4) -> PSC, ARR */
+	struct fsynth_timer t;
+	fsynth_solve((uint32_t)((float)(TIM_CLOCK_HZ << FSYNTH_Q) / nueva_frec_hz), &t);
+
+	out->psc = t.psc;
+	out->period_arr = t.arr;
+	out->ccr = (uint32_t)((float)(t.arr + 1) * nuevo_duty_pct);
+	out->duty_q16 = (uint32_t)(nuevo_duty_pct * 65536.0f + 0.5f);
+}
+
+
+/* ========= Versión entera (punto fijo) ========= */
+
+/*
+ * Sustituyendo V = VREF * raw / 4095 en f(V), el período deja de
+ * depender de una división por f y queda como una constante entre el
+ * código crudo:
+ *
+ *	TIM_CLOCK / f = (TIM_CLOCK * SETPOINT * 4095) / (VREF * TARGET_FREQ * raw)
+ *
+ * La constante (~17,869,090.9 ciclos) se guarda en Q28.4, el formato de
+ * período de fsynth_solve(), y el período es una sola división UDIV.
+ */
+#define PERIOD_K_Q4 \
+	((uint32_t)(((uint64_t)CONTROL_TIM_CLOCK_HZ * CONTROL_SETPOINT_MV * \
+		     CONTROL_ADC_FULL_SCALE << FSYNTH_Q) / \
+		    ((uint64_t)CONTROL_VREF_MV * CONTROL_TARGET_FREQ_HZ)))
+
+/* Período a la frecuencia mínima, en Q28.4 */
+#define PERIOD_MAX_Q4	((CONTROL_TIM_CLOCK_HZ << FSYNTH_Q) / CONTROL_MIN_FREQ_HZ)
+
+_Static_assert(((uint64_t)CONTROL_TIM_CLOCK_HZ * CONTROL_SETPOINT_MV *
+		CONTROL_ADC_FULL_SCALE << FSYNTH_Q) /
+	       ((uint64_t)CONTROL_VREF_MV * CONTROL_TARGET_FREQ_HZ) <= UINT32_MAX,
+	       "PERIOD_K_Q4 no cabe en 32 bits");
+_Static_assert(((uint64_t)CONTROL_TIM_CLOCK_HZ << FSYNTH_Q) / CONTROL_MIN_FREQ_HZ
+	       <= UINT32_MAX, "PERIOD_MAX_Q4 no cabe en 32 bits");
+
+void control_map_fixed(uint16_t amp_raw, uint16_t freq_raw,
+		       struct control_output *out)
+{
+	uint32_t period_q4 = PERIOD_MAX_Q4;
+
+	/* Por debajo de CONTROL_MIN_FREQ_HZ (incluido raw = 0) se satura */
+	if (freq_raw != 0) {
+		uint32_t p = PERIOD_K_Q4 / freq_raw;
+		if (p < PERIOD_MAX_Q4)
+			period_q4 = p;
+	}
+
+	struct fsynth_timer t;
+	fsynth_solve(period_q4, &t);
+
+	/*
+	 * Duty = (V / SETPOINT) * (SETPOINT / VREF) = raw / 4095, que ya está
+	 * entre 0 y 1. La división por la constante 4095 la convierte el
+	 * compilador en una multiplicación (UMULL).
+	 */
+	if (amp_raw > CONTROL_ADC_FULL_SCALE)
+		amp_raw = CONTROL_ADC_FULL_SCALE;
+
+	out->psc = t.psc;
+	out->period_arr = t.arr;
+	out->ccr = ((t.arr + 1) * amp_raw) / CONTROL_ADC_FULL_SCALE;
+	out->duty_q16 = ((uint32_t)amp_raw * 65536U + CONTROL_ADC_FULL_SCALE / 2) /
+			CONTROL_ADC_FULL_SCALE;
+}
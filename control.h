@@ -0,0 +1,87 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdint.h>
+
+/*
+ * Mapeo de las entradas analógicas a la salida PWM del TIM1.
+ *
+ * Convierte los códigos crudos del ADC (12 bits, ya promediados) en el
+ * prescaler (PSC), el período (ARR) y la comparación (CCR1) del TIM1. El
+ * par PSC/ARR lo elige fsynth_solve() (ver fsynth.h), así que cualquier
+ * frecuencia desde CONTROL_MIN_FREQ_HZ cabe en el ARR de 16 bits. Hay
+ * dos versiones con
+ * la misma interfaz:
+ *	control_map_float()	- Cálculo original en float (soft-float en el M3).
+ *	control_map_fixed()	- Sólo enteros de 32 bits, sin libgcc.
+ *
+ * CONTROL_FIXED_POINT elige cuál usa control_map() (por defecto la entera).
+ */
+#ifndef CONTROL_FIXED_POINT
+#define CONTROL_FIXED_POINT 1
+#endif
+
+/* ========= Parámetros del Mapeo ========= */
+
+#define CONTROL_TIM_CLOCK_HZ	72000000UL	// Reloj del TIM1 (APB2)
+#define CONTROL_ADC_FULL_SCALE	4095UL		// ADC de 12 bits
+#define CONTROL_VREF_MV		3300UL		// = VREF_VOLTS
+#define CONTROL_SETPOINT_MV	2000UL		// 2.0 V en la entrada...
+#define CONTROL_TARGET_FREQ_HZ	10000UL		// ... -> 10 kHz
+#define CONTROL_MIN_FREQ_HZ	100UL		// Límite inferior de frecuencia
+
+/* ========= Lazo Cerrado (PID, ver pid.h) ========= */
+
+/*
+ * Con CONTROL_PID_AMP / CONTROL_PID_FREQ la entrada correspondiente (PA0 /
+ * PA1) pasa a ser la realimentación de la salida (detector de amplitud /
+ * convertidor f-V, escalados para dar CONTROL_SETPOINT_MV en el punto de
+ * trabajo) y un PID calcula el código que se entrega a control_map() en
+ * lugar de la lectura. Por defecto los dos a 0: mapeo lineal sin PID.
+ */
+#ifndef CONTROL_PID_AMP
+#define CONTROL_PID_AMP		0
+#endif
+#ifndef CONTROL_PID_FREQ
+#define CONTROL_PID_FREQ	0
+#endif
+#define CONTROL_PID		(CONTROL_PID_AMP || CONTROL_PID_FREQ)
+
+/* Setpoint de los lazos: CONTROL_SETPOINT_MV en códigos de 12 bits (2482) */
+#define CONTROL_SETPOINT_RAW \
+	((CONTROL_SETPOINT_MV * CONTROL_ADC_FULL_SCALE + CONTROL_VREF_MV / 2) / \
+	 CONTROL_VREF_MV)
+
+/*
+ * Generador DDS (HAL_PWM_DDS): la misma ley f(V) da el incremento de
+ * fase, inc = raw * CONTROL_DDS_INC_K(fs), sin divisiones en el lazo.
+ * (f = raw * VREF * TARGET_FREQ / (SETPOINT * 4095), inc = f * 2^32 / fs)
+ */
+#define CONTROL_DDS_INC_K(fs_hz) \
+	((uint32_t)((((uint64_t)CONTROL_VREF_MV * CONTROL_TARGET_FREQ_HZ << 32) + \
+		     (uint64_t)CONTROL_SETPOINT_MV * CONTROL_ADC_FULL_SCALE * (fs_hz) / 2) / \
+		    ((uint64_t)CONTROL_SETPOINT_MV * CONTROL_ADC_FULL_SCALE * (fs_hz))))
+
+/**
+ * @brief Valores a escribir en el TIM1.
+ */
+struct control_output {
+	uint32_t psc;		// (PSC + 1) * (ARR + 1) ~= TIM_CLOCK / f
+	uint32_t period_arr;
+	uint32_t ccr;		// CCR1 = (ARR + 1) * duty
+	uint32_t duty_q16;	// duty en Q16, para hal_pwm_set_duty()
+};
+
+void control_map_float(uint16_t amp_raw, uint16_t freq_raw,
+		       struct control_output *out);
+
+void control_map_fixed(uint16_t amp_raw, uint16_t freq_raw,
+		       struct control_output *out);
+
+#if CONTROL_FIXED_POINT
+#define control_map control_map_fixed
+#else
+#define control_map control_map_float
+#endif
+
+#endif // CONTROL_H
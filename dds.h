@@ -0,0 +1,75 @@
+#ifndef DDS_H
+#define DDS_H
+
+#include <stdint.h>
+
+/*
+ * Síntesis digital directa (DDS) sobre el PWM del TIM1.
+ *
+ * El TIM1 funciona a una frecuencia fija fs (la de muestreo) y cada
+ * período lleva un CCR1 distinto: tras el filtro RC de la salida queda
+ * la forma de onda. Las muestras salen de un acumulador de fase de 32
+ * bits y una tabla de DDS_LUT_LEN valores:
+ *
+ *	fase += inc			(f = inc * fs / 2^32)
+ *	CCR1 = medio + tabla[fase >> 24] * escala
+ *
+ * El DMA copia una muestra por evento de actualización desde un búfer
+ * circular de dos mitades; la CPU sólo calcula una mitad entera con
+ * dds_fill() cuando el DMA termina de leerla (HT/TC, ver
+ * hal_dds_half_ready()).
+ *
+ * inc, escala y tabla son palabras de 32 bits: una tarea las cambia con
+ * dds_set_*() mientras la ISR las lee, sin bloqueos.
+ */
+
+#define DDS_LUT_LOG2	8
+#define DDS_LUT_LEN	(1U << DDS_LUT_LOG2)
+
+/* Formas de onda incluidas (Q15, un ciclo, en fase con el seno) */
+extern const int16_t dds_seno[DDS_LUT_LEN];
+extern const int16_t dds_triangulo[DDS_LUT_LEN];
+
+struct dds {
+	volatile uint32_t inc;			// Incremento de fase por muestra
+	volatile uint32_t escala;		// Semiamplitud, en cuentas de CCR
+	const int16_t *volatile tabla;		// Forma de onda (Q15)
+	uint32_t fase;				// Sólo dds_fill()
+	uint32_t medio;				// Nivel de reposo: período / 2
+};
+
+/**
+ * @brief Inicializa el generador para un período del TIM1 de 'period'
+ *        cuentas (ARR + 1), en reposo (salida = medio) y con el seno.
+ */
+void dds_init(struct dds *d, uint32_t period);
+
+/**
+ * @brief Cambia la forma de onda (DDS_LUT_LEN valores Q15, un ciclo).
+ *
+ * Una tabla arbitraria la pone la aplicación; debe seguir existiendo
+ * mientras esté seleccionada.
+ */
+void dds_set_waveform(struct dds *d, const int16_t *tabla);
+
+/**
+ * @brief Fija frecuencia (incremento de fase) y amplitud (Q16, 65536 =
+ *        pico a pico completo, de 0 al período).
+ */
+void dds_set_output(struct dds *d, uint32_t inc, uint32_t amp_q16);
+
+/**
+ * @brief Incremento de fase para 'f_hz' con muestreo 'fs_hz'.
+ *
+ * División de 64 bits: para configurar, no para el lazo.
+ */
+uint32_t dds_inc_from_hz(uint32_t fs_hz, uint32_t f_hz);
+
+/**
+ * @brief Calcula las siguientes 'n' muestras (valores de CCR1).
+ *
+ * Se llama desde la ISR del DMA con la mitad del búfer ya leída.
+ */
+void dds_fill(struct dds *d, volatile uint16_t *buf, unsigned n);
+
+#endif // DDS_H
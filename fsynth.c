@@ -0,0 +1,57 @@
+#include "fsynth.h"
+
+/* Máximo de ARR + 1 (y de PSC + 1) en un timer de 16 bits */
+#define CUENTA_MAX	65536U
+
+uint32_t fsynth_period_q4(uint32_t clock_hz, uint32_t freq_hz)
+{
+	uint64_t p = (((uint64_t)clock_hz << FSYNTH_Q) + freq_hz / 2) / freq_hz;
+	return p > UINT32_MAX ? UINT32_MAX : (uint32_t)p;
+}
+
+void fsynth_solve(uint32_t period_q4, struct fsynth_timer *t)
+{
+	if (period_q4 < FSYNTH_PERIOD_MIN_Q4)
+		period_q4 = FSYNTH_PERIOD_MIN_Q4;
+
+	/* Prescaler mínimo: ceil(período / 65536). Con p_min = 1 el período
+	 * es >= 2 ciclos y a >= 2 (ARR >= 1); si no, a > 65536 / 3. */
+	uint32_t p_min = (period_q4 - 1) / (CUENTA_MAX << FSYNTH_Q) + 1;
+
+	/* Candidatos: hasta 2 * p_min (ARR + 1 >= la mitad del máximo) */
+	uint32_t p_max = p_min + FSYNTH_CANDIDATOS - 1;
+	if (p_max > 2 * p_min - 1)
+		p_max = 2 * p_min - 1;
+	if (p_max > CUENTA_MAX)
+		p_max = CUENTA_MAX;
+
+	uint32_t best_p = p_min, best_a = 0, best_err = UINT32_MAX;
+
+	for (uint32_t p = p_min; p <= p_max; ++p) {
+		/*
+		 * a = round(período / p). Se trabaja con el resto en lugar de
+		 * multiplicar a * p, que con períodos de 2^28 ciclos no cabe en
+		 * 32 bits.
+		 */
+		uint32_t step = p << FSYNTH_Q;
+		uint32_t a = period_q4 / step;
+		uint32_t rem = period_q4 - a * step;
+		uint32_t err = rem;
+
+		if (rem > step - rem && a < CUENTA_MAX) {
+			a++;
+			err = step - rem;
+		}
+		if (err < best_err) {
+			best_err = err;
+			best_p = p;
+			best_a = a;
+			if (err == 0)
+				break;
+		}
+	}
+
+	t->psc = best_p - 1;
+	t->arr = best_a - 1;
+	t->err_q4 = best_err;
+}
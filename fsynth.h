@@ -0,0 +1,59 @@
+#ifndef FSYNTH_H
+#define FSYNTH_H
+
+#include <stdint.h>
+
+/*
+ * Síntesis de frecuencia para un timer de 16 bits: elige el par
+ * (PSC, ARR) cuyo período (PSC + 1) * (ARR + 1) más se acerca al pedido.
+ *
+ * El período se da en ciclos del reloj del timer, en Q28.4, así que el
+ * módulo no depende del reloj: con 72 MHz cubre de ~0.27 Hz (2^28
+ * ciclos) hasta fclk / 2.
+ *
+ * Criterio:
+ *	1. Parte del prescaler mínimo, el que deja ARR + 1 lo más cerca
+ *	   posible de 65536 (máxima resolución del duty).
+ *	2. Prueba además los prescalers siguientes hasta 2 * mínimo - 1 (ARR
+ *	   + 1 no baja de la mitad del que da el mínimo: se pierde menos de
+ *	   1 bit de resolución), como mucho FSYNTH_CANDIDATOS, y se queda
+ *	   con el de menor error de período.
+ *	   A igual error, el de mayor ARR.
+ * Por encima de fclk / 65536 (1099 Hz a 72 MHz) el prescaler es 1 y
+ * cualquier período entero es exacto: una sola división.
+ * Peor caso: FSYNTH_CANDIDATOS divisiones de 32 bits (UDIV, 2-12 ciclos
+ * cada una en el Cortex-M3).
+ */
+
+/* Prescalers probados como máximo por llamada */
+#ifndef FSYNTH_CANDIDATOS
+#define FSYNTH_CANDIDATOS	16U
+#endif
+
+#define FSYNTH_Q		4U			// Bits fraccionarios del período
+#define FSYNTH_PERIOD_MIN_Q4	(2U << FSYNTH_Q)	// ARR = 1: la mínima con PWM
+
+/**
+ * @brief Valores de registro elegidos.
+ */
+struct fsynth_timer {
+	uint32_t psc;		// PSC = prescaler - 1 (0..65535)
+	uint32_t arr;		// ARR = ciclos por período - 1 (1..65535)
+	uint32_t err_q4;	// |período real - pedido|, ciclos en Q28.4
+};
+
+/**
+ * @brief Período en Q28.4 para 'freq_hz' con un reloj 'clock_hz', redondeado.
+ *
+ * División de 64 bits: para configurar, no para el lazo de control.
+ */
+uint32_t fsynth_period_q4(uint32_t clock_hz, uint32_t freq_hz);
+
+/**
+ * @brief Elige PSC y ARR para un período de 'period_q4' ciclos (Q28.4).
+ *
+ * Períodos por debajo de FSYNTH_PERIOD_MIN_Q4 se saturan a él.
+ */
+void fsynth_solve(uint32_t period_q4, struct fsynth_timer *t);
+
+#endif // FSYNTH_H
@@ -0,0 +1,246 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+/*
+ * Capa de abstracción de hardware (HAL) de la aplicación.
+ *
+ * app_tasks.c sólo accede a los periféricos a través de estas funciones.
+ * Hay dos implementaciones, elegidas al enlazar:
+ *	hal_opencm3.c	- Blue Pill (libopencm3), usada por Makefile.
+ *	host/hal_mock.c	- Simulación en el host, usada por Makefile.host.
+ *			  Registra cada acceso y cuenta los registros que
+ *			  tocaría la versión real.
+ *
+ * La inicialización del hardware sigue en config.c (sólo en el target).
+ */
+
+/* ========= Fuente de muestras ADC (bloques por DMA) ========= */
+
+/*
+ * El ADC convierte continuamente la secuencia {CH0 = Amplitud,
+ * CH1 = Frecuencia} y el DMA la guarda intercalada en un búfer circular
+ * de dos mitades. Cada vez que se llena una mitad (interrupciones HT/TC
+ * del DMA) la HAL la entrega a hal_adc_block_ready().
+ */
+
+/*
+ * Disparo de cada secuencia {CH0, CH1}:
+ *	1 = TRGO del TIM3, exactamente HAL_ADC_SAMPLE_RATE_HZ pares/s
+ *	    (por defecto; ver adc_trigger_setup() en config.c).
+ *	0 = Modo continuo: el ritmo lo fijan el reloj del ADC y el tiempo
+ *	    de muestreo (~146,341 pares/s).
+ * En los dos el instante de muestreo no está sincronizado con el TIM1: el
+ * TIM3 solo fija el ritmo, la fase respecto al PWM sigue derivando.
+ */
+#ifndef HAL_ADC_TIMER_TRIGGER
+#define HAL_ADC_TIMER_TRIGGER	1
+#endif
+
+/* Ritmo de muestreo con disparo por TIM3 (pares {amp, freq} por segundo) */
+#ifndef HAL_ADC_SAMPLE_RATE_HZ
+#define HAL_ADC_SAMPLE_RATE_HZ	10000UL
+#endif
+
+#if HAL_ADC_TIMER_TRIGGER
+
+#define HAL_ADC_PAIR_RATE_HZ	HAL_ADC_SAMPLE_RATE_HZ
+
+/* Pares {amp, freq} por medio búfer: 2^5 = 32 (3.2ms a 10kHz) */
+#ifndef HAL_ADC_BLOCK_LOG2
+#define HAL_ADC_BLOCK_LOG2	5
+#endif
+
+#else
+
+/*
+ * Pares producidos por segundo en modo continuo:
+ * ADCCLK = 72MHz / 6 = 12MHz, 28.5 + 12.5 ciclos por conversión,
+ * 2 conversiones por par -> ~146,341 pares/s (~292,683 muestras/s).
+ */
+#define HAL_ADC_PAIR_RATE_HZ	(12000000UL / ((285UL + 125UL) * 2UL / 10UL))
+
+/* Pares {amp, freq} por medio búfer: 2^7 = 128 */
+#ifndef HAL_ADC_BLOCK_LOG2
+#define HAL_ADC_BLOCK_LOG2	7
+#endif
+
+#endif // HAL_ADC_TIMER_TRIGGER
+
+#define HAL_ADC_BLOCK_PAIRS	(1U << HAL_ADC_BLOCK_LOG2)
+
+/* Tamaño total del búfer de DMA, en medias palabras */
+#define HAL_ADC_DMA_LEN		(2U * 2U * HAL_ADC_BLOCK_PAIRS)
+
+/**
+ * @brief Bloque de muestras listo. Lo implementa la aplicación.
+ *
+ * Se llama desde la ISR del DMA (contexto de interrupción) con una
+ * mitad del búfer que el DMA no está escribiendo.
+ * @param block Pares intercalados: block[2*i] = amp, block[2*i+1] = freq.
+ * @param pairs Número de pares (HAL_ADC_BLOCK_PAIRS).
+ */
+void hal_adc_block_ready(const volatile uint16_t *block, unsigned pairs);
+
+/**
+ * @brief Medios búferes que se perdieron porque la ISR llegó tarde
+ *        (el DMA ya había completado también la otra mitad).
+ */
+uint32_t hal_adc_overruns(void);
+
+
+/* ========= Salida PWM (TIM1 CH1, PA8) ========= */
+
+/**
+ * @brief Escribe el prescaler (PSC), el período (ARR) y la comparación
+ *        (CCR1) del PWM.
+ *
+ * Los tres se aplican juntos en el próximo evento de actualización del
+ * TIM1 (fin del período en curso), sin pulsos cortos ni estirados.
+ */
+void hal_pwm_set(uint32_t psc, uint32_t period_arr, uint32_t ccr);
+
+/*
+ * Dithering del duty (ver pwm_dither.h):
+ *	1 = El DMA1 Canal 5 (TIM1_UP) copia en cada evento de actualización
+ *	    un CCR1 nuevo desde un patrón circular de HAL_PWM_DITHER_LEN
+ *	    valores: HAL_PWM_DITHER_LOG2 bits de resolución más.
+ *	0 = CCR1 fijo (por defecto).
+ */
+#ifndef HAL_PWM_DITHER
+#define HAL_PWM_DITHER		0
+#endif
+
+/* Longitud del patrón: 2^4 = 16 períodos, 4 bits más */
+#ifndef HAL_PWM_DITHER_LOG2
+#define HAL_PWM_DITHER_LOG2	4
+#endif
+#define HAL_PWM_DITHER_LEN	(1U << HAL_PWM_DITHER_LOG2)
+
+/**
+ * @brief Como hal_pwm_set(), con el duty en Q16 (65536 = 100%).
+ *
+ * Con HAL_PWM_DITHER el duty se reparte entre los períodos del patrón;
+ * si no, se redondea al CCR1 más próximo.
+ */
+void hal_pwm_set_duty(uint32_t psc, uint32_t period_arr, uint32_t duty_q16);
+
+
+/* ========= Generador DDS (TIM1 CH1 a frecuencia fija, ver dds.h) ========= */
+
+/*
+ * Salida del TIM1:
+ *	1 = Generador de forma de onda: el TIM1 muestrea a HAL_DDS_FS_HZ y
+ *	    el DMA1 Canal 5 (TIM1_UP) copia un CCR1 por período desde un
+ *	    búfer circular de dos mitades. Al terminar cada mitad (HT/TC)
+ *	    la HAL pide la siguiente con hal_dds_half_ready().
+ *	    hal_pwm_set() y hal_pwm_set_duty() no se usan.
+ *	0 = PWM de frecuencia y duty variables (por defecto).
+ */
+#ifndef HAL_PWM_DDS
+#define HAL_PWM_DDS		0
+#endif
+
+#if HAL_PWM_DDS && HAL_PWM_DITHER
+#error "HAL_PWM_DDS y HAL_PWM_DITHER usan los dos el DMA1 Canal 5"
+#endif
+
+/* Período del TIM1 (ARR + 1) en modo DDS: 200 kHz, ~8.5 bits por muestra */
+#ifndef HAL_DDS_PERIOD
+#define HAL_DDS_PERIOD		360U
+#endif
+#define HAL_DDS_FS_HZ		(72000000UL / HAL_DDS_PERIOD)
+
+/* Muestras por mitad: 2^6 = 64 (320us a 200 kHz) */
+#ifndef HAL_DDS_HALF_LOG2
+#define HAL_DDS_HALF_LOG2	6
+#endif
+#define HAL_DDS_HALF_LEN	(1U << HAL_DDS_HALF_LOG2)
+
+/**
+ * @brief Mitad del búfer del DDS libre. Lo implementa la aplicación.
+ *
+ * Se llama desde la ISR del DMA1 Canal 5 con la mitad que el DMA acaba
+ * de leer; debe llenarla (HAL_DDS_HALF_LEN valores de CCR1) antes de que
+ * el DMA termine la otra. No debe usar el kernel (prioridad por encima
+ * de configMAX_SYSCALL_INTERRUPT_PRIORITY).
+ */
+void hal_dds_half_ready(volatile uint16_t *half, unsigned n);
+
+/**
+ * @brief Mitades que la ISR no llegó a rellenar a tiempo.
+ */
+uint32_t hal_dds_overruns(void);
+
+
+/* ========= Barridos de frecuencia (TIM1 CH1, ver sweep.h) ========= */
+
+/*
+ * Barridos por DMA:
+ *	1 = hal_pwm_sweep_start() pone el DMA1 Canal 5 (TIM1_UP) a cargar
+ *	    {ARR, RCR, CCR1} en cada evento de actualización, en ráfaga por
+ *	    TIM1_DMAR, desde un búfer circular de dos mitades que la
+ *	    aplicación rellena en hal_sweep_half_ready(). Entre barridos el
+ *	    PWM sigue con hal_pwm_set().
+ *	0 = Sin barridos (por defecto).
+ */
+#ifndef HAL_PWM_SWEEP
+#define HAL_PWM_SWEEP		0
+#endif
+
+#if HAL_PWM_SWEEP && (HAL_PWM_DDS || HAL_PWM_DITHER)
+#error "HAL_PWM_SWEEP comparte el DMA1 Canal 5 con HAL_PWM_DDS y HAL_PWM_DITHER"
+#endif
+
+/* Períodos por mitad: 2^5 = 32 (3.2ms a 10 kHz, 32us a 1 MHz) */
+#ifndef HAL_SWEEP_HALF_LOG2
+#define HAL_SWEEP_HALF_LOG2	5
+#endif
+#define HAL_SWEEP_HALF_LEN	(1U << HAL_SWEEP_HALF_LOG2)
+
+/**
+ * @brief Arranca el barrido con el prescaler 'psc'.
+ *
+ * Pide antes las dos mitades del búfer a hal_sweep_half_ready(). El
+ * primer período del barrido se escribe directamente (junto con el PSC)
+ * y entra en el próximo evento de actualización; desde ahí cada período
+ * lo carga el DMA, sin intervención de la CPU ni del RTOS. Habilita la
+ * ISR del DMA1 Canal 5 al final, con el búfer ya lleno.
+ */
+void hal_pwm_sweep_start(uint32_t psc);
+
+/**
+ * @brief Detiene el DMA del barrido. El TIM1 sigue con el último
+ *        período cargado hasta el próximo hal_pwm_set().
+ *
+ * Al volver la ISR del DMA1 Canal 5 no está pendiente ni puede entrar
+ * hasta el próximo hal_pwm_sweep_start(): el estado que lee
+ * hal_sweep_half_ready() se puede cambiar sin más. Se puede llamar desde
+ * hal_sweep_half_ready().
+ */
+void hal_pwm_sweep_stop(void);
+
+/**
+ * @brief Mitad del búfer del barrido libre. Lo implementa la aplicación.
+ *
+ * Se llama desde la ISR del DMA1 Canal 5 (y desde hal_pwm_sweep_start())
+ * con 'periods' períodos de 3 medias palabras {ARR, RCR, CCR1} por
+ * llenar. Mismas restricciones que hal_dds_half_ready().
+ */
+void hal_sweep_half_ready(volatile uint16_t *half, unsigned periods);
+
+/**
+ * @brief Mitades que la ISR no llegó a rellenar a tiempo.
+ */
+uint32_t hal_sweep_overruns(void);
+
+
+/* ========= LED (PC13) ========= */
+
+/**
+ * @brief Conmuta el LED de estado.
+ */
+void hal_led_toggle(void);
+
+#endif // HAL_H
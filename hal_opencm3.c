@@ -0,0 +1,235 @@
+/*
+ * Implementación de hal.h sobre libopencm3 (Blue Pill, STM32F103C8T6).
+ *
+ * Los periféricos se configuran en config.c; aquí sólo están los
+ * accesos en tiempo de ejecución y la ISR del DMA del ADC.
+ */
+#include <libopencm3/cm3/nvic.h>
+#include <libopencm3/stm32/dma.h>
+#include <libopencm3/stm32/gpio.h>
+#include <libopencm3/stm32/timer.h>
+
+#include "hal.h"
+#include "pwm_dither.h"
+
+/*
+ * Búfer circular de destino del DMA: dos mitades de
+ * HAL_ADC_BLOCK_PAIRS pares {amp, freq} intercalados.
+ * Es global (no estático) para que config.c pueda verlo
+ * usando 'extern'. El hardware DMA escribe aquí.
+ */
+volatile uint16_t adc_dma_buffer[HAL_ADC_DMA_LEN];
+
+static volatile uint32_t adc_overruns;
+
+#if HAL_PWM_DITHER
+/*
+ * Patrón de CCR1 que el DMA1 Canal 5 copia en cada UEV del TIM1 (ver
+ * pwm_setup()). Global por el mismo motivo que adc_dma_buffer.
+ */
+volatile uint16_t pwm_dither_buffer[HAL_PWM_DITHER_LEN];
+#endif
+
+#if HAL_PWM_DDS
+/* Muestras (CCR1) del DDS: dos mitades que lee el DMA1 Canal 5. */
+volatile uint16_t pwm_dds_buffer[2 * HAL_DDS_HALF_LEN];
+
+static volatile uint32_t dds_overruns;
+#endif
+
+#if HAL_PWM_SWEEP
+/* Períodos {ARR, RCR, CCR1} del barrido: dos mitades para el DMA1 Canal 5. */
+static volatile uint16_t pwm_sweep_buffer[2 * 3 * HAL_SWEEP_HALF_LEN];
+
+static volatile uint32_t sweep_overruns;
+#endif
+
+
+/**
+ * @brief ISR del DMA1 Canal 1: mitad (HT) o final (TC) del búfer.
+ */
+void dma1_channel1_isr(void)
+{
+	int ht = dma_get_interrupt_flag(DMA1, DMA_CHANNEL1, DMA_HTIF);
+	int tc = dma_get_interrupt_flag(DMA1, DMA_CHANNEL1, DMA_TCIF);
+
+	/* Las dos a la vez: la primera mitad ya se está sobrescribiendo */
+	if (ht && tc)
+		adc_overruns++;
+
+	if (ht) {
+		dma_clear_interrupt_flags(DMA1, DMA_CHANNEL1, DMA_HTIF);
+		hal_adc_block_ready(&adc_dma_buffer[0], HAL_ADC_BLOCK_PAIRS);
+	}
+	if (tc) {
+		dma_clear_interrupt_flags(DMA1, DMA_CHANNEL1, DMA_TCIF);
+		hal_adc_block_ready(&adc_dma_buffer[HAL_ADC_DMA_LEN / 2],
+				    HAL_ADC_BLOCK_PAIRS);
+	}
+}
+
+uint32_t hal_adc_overruns(void)
+{
+	return adc_overruns;
+}
+
+/*
+ * PSC, ARR y CCR1 tienen precarga (el PSC siempre; ARPE y OC1PE, ver
+ * pwm_setup()): las
+ * escrituras van a los registros de precarga y pasan a los activos en
+ * el próximo evento de actualización (UEV), al final del período en
+ * curso. Así un ARR menor que el CNT actual ya no hace que el contador
+ * dé la vuelta por 65535.
+ *
+ * Con UDIS a 1 el desbordamiento no genera UEV (el contador sigue
+ * contando con los valores activos), así que el UEV no puede caer entre
+ * las escrituras: los tres valores se aplican enteros o no se aplican,
+ * nunca ARR nuevo con CCR o PSC viejos. Si el desbordamiento coincide
+ * con la ventana, entran un período más tarde.
+ */
+void hal_pwm_set(uint32_t psc, uint32_t period_arr, uint32_t ccr)
+{
+	timer_disable_update_event(TIM1);		// TIM1_CR1 |= UDIS
+	timer_set_prescaler(TIM1, psc);			// TIM1_PSC (precarga)
+	timer_set_period(TIM1, period_arr);		// TIM1_ARR (precarga)
+	timer_set_oc_value(TIM1, TIM_OC1, ccr);		// TIM1_CCR1 (precarga)
+	timer_enable_update_event(TIM1);		// TIM1_CR1 &= ~UDIS
+}
+
+/*
+ * Con dithering, el patrón se reescribe dentro del mismo paréntesis de
+ * UDIS que PSC y ARR: sin UEV tampoco hay petición de DMA, así que el
+ * DMA no lee el patrón a medias y los períodos siguientes usan el patrón
+ * nuevo entero, con el ARR nuevo. El DMA sigue desde su posición.
+ */
+void hal_pwm_set_duty(uint32_t psc, uint32_t period_arr, uint32_t duty_q16)
+{
+#if HAL_PWM_DITHER
+	timer_disable_update_event(TIM1);		// TIM1_CR1 |= UDIS
+	timer_set_prescaler(TIM1, psc);			// TIM1_PSC (precarga)
+	timer_set_period(TIM1, period_arr);		// TIM1_ARR (precarga)
+	pwm_dither_fill(pwm_dither_buffer, HAL_PWM_DITHER_LOG2,
+			period_arr + 1, duty_q16);	// RAM, no registros
+	timer_enable_update_event(TIM1);		// TIM1_CR1 &= ~UDIS
+#else
+	uint16_t ccr;
+	hal_pwm_set(psc, period_arr,
+		    pwm_dither_fill(&ccr, 0, period_arr + 1, duty_q16));
+#endif
+}
+
+#if HAL_PWM_DDS
+/**
+ * @brief ISR del DMA1 Canal 5: el DMA ha leído una mitad del búfer del DDS.
+ */
+void dma1_channel5_isr(void)
+{
+	int ht = dma_get_interrupt_flag(DMA1, DMA_CHANNEL5, DMA_HTIF);
+	int tc = dma_get_interrupt_flag(DMA1, DMA_CHANNEL5, DMA_TCIF);
+
+	/* Las dos a la vez: el DMA ya está repitiendo muestras viejas */
+	if (ht && tc)
+		dds_overruns++;
+
+	if (ht) {
+		dma_clear_interrupt_flags(DMA1, DMA_CHANNEL5, DMA_HTIF);
+		hal_dds_half_ready(&pwm_dds_buffer[0], HAL_DDS_HALF_LEN);
+	}
+	if (tc) {
+		dma_clear_interrupt_flags(DMA1, DMA_CHANNEL5, DMA_TCIF);
+		hal_dds_half_ready(&pwm_dds_buffer[HAL_DDS_HALF_LEN], HAL_DDS_HALF_LEN);
+	}
+}
+
+uint32_t hal_dds_overruns(void)
+{
+	return dds_overruns;
+}
+#endif
+
+#if HAL_PWM_SWEEP
+/*
+ * TIM1_DCR: ráfaga de DBL + 1 = 3 transferencias a partir del registro
+ * DBA = 11 (TIM1_ARR, 0x2C / 4): ARR, RCR y CCR1 por cada petición de
+ * DMA del UEV. Los tres tienen precarga, así que los valores que carga
+ * el DMA en un UEV definen el período siguiente entero.
+ */
+#define SWEEP_DCR	((2U << 8) | 11U)
+
+void hal_pwm_sweep_start(uint32_t psc)
+{
+	uint16_t primero[3];
+
+	hal_sweep_half_ready(primero, 1);
+	hal_sweep_half_ready(&pwm_sweep_buffer[0], HAL_SWEEP_HALF_LEN);
+	hal_sweep_half_ready(&pwm_sweep_buffer[3 * HAL_SWEEP_HALF_LEN],
+			     HAL_SWEEP_HALF_LEN);
+
+	dma_disable_channel(DMA1, DMA_CHANNEL5);
+	dma_set_peripheral_address(DMA1, DMA_CHANNEL5, (uint32_t)&TIM_DMAR(TIM1));
+	dma_set_memory_address(DMA1, DMA_CHANNEL5, (uint32_t)pwm_sweep_buffer);
+	dma_set_number_of_data(DMA1, DMA_CHANNEL5, 2 * 3 * HAL_SWEEP_HALF_LEN);
+	dma_clear_interrupt_flags(DMA1, DMA_CHANNEL5, DMA_HTIF | DMA_TCIF);
+
+	/* Primer período (con el PSC nuevo) en el próximo UEV; el DMA carga
+	 * en ese mismo UEV el segundo */
+	timer_disable_update_event(TIM1);		// TIM1_CR1 |= UDIS
+	timer_set_prescaler(TIM1, psc);
+	timer_set_period(TIM1, primero[0]);
+	timer_set_oc_value(TIM1, TIM_OC1, primero[2]);
+	TIM_DCR(TIM1) = SWEEP_DCR;
+	dma_enable_channel(DMA1, DMA_CHANNEL5);
+	nvic_enable_irq(NVIC_DMA1_CHANNEL5_IRQ);
+	timer_enable_irq(TIM1, TIM_DIER_UDE);		// Petición de DMA en cada UEV
+	timer_enable_update_event(TIM1);		// TIM1_CR1 &= ~UDIS
+}
+
+/*
+ * La ISR está por encima de configMAX_SYSCALL_INTERRUPT_PRIORITY: ninguna
+ * sección crítica la para. Se deshabilita en el NVIC (y se borra si quedó
+ * pendiente) para que la aplicación pueda tocar el estado del barrido
+ * hasta el siguiente hal_pwm_sweep_start(). DSB + ISB: efectiva antes de
+ * volver.
+ */
+void hal_pwm_sweep_stop(void)
+{
+	timer_disable_irq(TIM1, TIM_DIER_UDE);
+	dma_disable_channel(DMA1, DMA_CHANNEL5);
+	nvic_disable_irq(NVIC_DMA1_CHANNEL5_IRQ);
+	nvic_clear_pending_irq(NVIC_DMA1_CHANNEL5_IRQ);
+	__asm__ volatile("dsb\n\tisb" ::: "memory");
+}
+
+/**
+ * @brief ISR del DMA1 Canal 5: el DMA ha leído una mitad del barrido.
+ */
+void dma1_channel5_isr(void)
+{
+	int ht = dma_get_interrupt_flag(DMA1, DMA_CHANNEL5, DMA_HTIF);
+	int tc = dma_get_interrupt_flag(DMA1, DMA_CHANNEL5, DMA_TCIF);
+
+	/* Las dos a la vez: el DMA ya está repitiendo períodos viejos */
+	if (ht && tc)
+		sweep_overruns++;
+
+	if (ht) {
+		dma_clear_interrupt_flags(DMA1, DMA_CHANNEL5, DMA_HTIF);
+		hal_sweep_half_ready(&pwm_sweep_buffer[0], HAL_SWEEP_HALF_LEN);
+	}
+	if (tc) {
+		dma_clear_interrupt_flags(DMA1, DMA_CHANNEL5, DMA_TCIF);
+		hal_sweep_half_ready(&pwm_sweep_buffer[3 * HAL_SWEEP_HALF_LEN],
+				     HAL_SWEEP_HALF_LEN);
+	}
+}
+
+uint32_t hal_sweep_overruns(void)
+{
+	return sweep_overruns;
+}
+#endif
+
+void hal_led_toggle(void)
+{
+	gpio_toggle(GPIOC, GPIO13);			// Lee ODR, escribe BSRR
+}
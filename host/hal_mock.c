@@ -0,0 +1,260 @@
+/*
+ * Implementación de hal.h para el host (ver hal_mock.h).
+ */
+#include "hal_mock.h"
+#include "pwm_dither.h"
+
+struct hal_mock_state hal_mock = {
+#if HAL_PWM_DDS
+	.pwm_psc = 0,		// Valores de pwm_setup() en modo DDS
+	.pwm_arr = HAL_DDS_PERIOD - 1,
+	.pwm_ccr = HAL_DDS_PERIOD / 2,
+	.dds_min = UINT16_MAX,
+#else
+	.pwm_psc = 0,		// Valores de pwm_setup()
+	.pwm_arr = 7199,
+	.pwm_ccr = 3600,
+#endif
+};
+
+/* Búfer circular simulado, con la misma disposición que adc_dma_buffer */
+static uint16_t mock_dma_buffer[HAL_ADC_DMA_LEN];
+static unsigned mock_dma_pos;		// Próximo par a escribir
+static uint64_t mock_pair_frac;		// Resto de pares (en pares * 1e6)
+
+void hal_mock_set_adc(uint16_t amp, uint16_t freq)
+{
+	hal_mock.adc_amp  = amp;
+	hal_mock.adc_freq = freq;
+}
+
+void hal_mock_reset_counters(void)
+{
+	hal_mock.adc_blocks  = 0;
+	hal_mock.adc_pairs_produced = 0;
+	hal_mock.pwm_updates = 0;
+	hal_mock.led_toggles = 0;
+#if HAL_PWM_DDS
+	hal_mock.dds_samples = 0;
+	hal_mock.dds_cruces  = 0;
+	hal_mock.dds_min     = UINT16_MAX;
+	hal_mock.dds_max     = 0;
+#endif
+#if HAL_PWM_SWEEP
+	hal_mock.sweep_periodos = 0;
+	hal_mock.sweep_f_min    = UINT32_MAX;
+	hal_mock.sweep_f_max    = 0;
+#endif
+	hal_mock.reg_reads   = 0;
+	hal_mock.reg_writes  = 0;
+	hal_mock.pwm_reg_writes = 0;
+}
+
+void hal_mock_adc_advance(uint32_t elapsed_us)
+{
+	mock_pair_frac += (uint64_t)elapsed_us * HAL_ADC_PAIR_RATE_HZ;
+	uint64_t pairs = mock_pair_frac / 1000000U;
+	mock_pair_frac %= 1000000U;
+
+	hal_mock.adc_pairs_produced += pairs;
+
+	while (pairs--) {
+		mock_dma_buffer[2 * mock_dma_pos]     = hal_mock.adc_amp;
+		mock_dma_buffer[2 * mock_dma_pos + 1] = hal_mock.adc_freq;
+		mock_dma_pos++;
+
+		/* HT o TC: mitad completa */
+		if (mock_dma_pos % HAL_ADC_BLOCK_PAIRS == 0) {
+			unsigned half = mock_dma_pos / HAL_ADC_BLOCK_PAIRS - 1;
+			mock_dma_pos %= 2 * HAL_ADC_BLOCK_PAIRS;
+
+			hal_mock.adc_blocks++;
+			hal_mock.reg_reads  += 2;	// DMA_ISR (HTIF, TCIF)
+			hal_mock.reg_writes += 1;	// DMA_IFCR
+			hal_adc_block_ready(&mock_dma_buffer[half * HAL_ADC_DMA_LEN / 2],
+					    HAL_ADC_BLOCK_PAIRS);
+		}
+	}
+}
+
+uint32_t hal_adc_overruns(void)
+{
+	return 0;
+}
+
+#if HAL_PWM_DDS
+static uint16_t mock_dds_buffer[2 * HAL_DDS_HALF_LEN];
+static unsigned mock_dds_pos;			// Próxima muestra a leer
+static uint64_t mock_dds_frac;			// Resto (en muestras * 1e6)
+static int mock_dds_alto;			// Última muestra >= medio
+static int mock_dds_listo;
+
+void hal_mock_dds_advance(uint32_t elapsed_us)
+{
+	if (!mock_dds_listo) {		// Reposo, como pwm_setup()
+		for (unsigned i = 0; i < 2 * HAL_DDS_HALF_LEN; ++i)
+			mock_dds_buffer[i] = HAL_DDS_PERIOD / 2;
+		mock_dds_listo = 1;
+	}
+
+	mock_dds_frac += (uint64_t)elapsed_us * HAL_DDS_FS_HZ;
+	uint64_t n = mock_dds_frac / 1000000U;
+	mock_dds_frac %= 1000000U;
+
+	hal_mock.dds_samples += n;
+
+	while (n--) {
+		uint16_t ccr = mock_dds_buffer[mock_dds_pos++];
+		int alto = ccr >= HAL_DDS_PERIOD / 2;
+
+		if (alto && !mock_dds_alto)
+			hal_mock.dds_cruces++;
+		mock_dds_alto = alto;
+		if (ccr < hal_mock.dds_min) hal_mock.dds_min = ccr;
+		if (ccr > hal_mock.dds_max) hal_mock.dds_max = ccr;
+
+		/* HT o TC: mitad leída */
+		if (mock_dds_pos % HAL_DDS_HALF_LEN == 0) {
+			unsigned half = mock_dds_pos / HAL_DDS_HALF_LEN - 1;
+			mock_dds_pos %= 2 * HAL_DDS_HALF_LEN;
+
+			hal_mock.reg_reads  += 2;	// DMA_ISR (HTIF, TCIF)
+			hal_mock.reg_writes += 1;	// DMA_IFCR
+			hal_dds_half_ready(&mock_dds_buffer[half * HAL_DDS_HALF_LEN],
+					   HAL_DDS_HALF_LEN);
+		}
+	}
+}
+
+uint32_t hal_dds_overruns(void)
+{
+	return 0;
+}
+#endif
+
+#if HAL_PWM_SWEEP
+#define MOCK_TIM1_HZ	72000000UL
+
+static uint16_t mock_sweep_buffer[2 * 3 * HAL_SWEEP_HALF_LEN];
+static unsigned mock_sweep_pos;			// Próximo período a leer
+static int mock_sweep_on;
+static uint64_t mock_sweep_acc;			// Cuentas de 72 MHz pendientes
+static uint32_t mock_sweep_psc, mock_sweep_arr;	// Período activo (sombra)
+
+void hal_pwm_sweep_start(uint32_t psc)
+{
+	uint16_t primero[3];
+
+	hal_sweep_half_ready(primero, 1);
+	hal_sweep_half_ready(&mock_sweep_buffer[0], HAL_SWEEP_HALF_LEN);
+	hal_sweep_half_ready(&mock_sweep_buffer[3 * HAL_SWEEP_HALF_LEN],
+			     HAL_SWEEP_HALF_LEN);
+
+	/* El período en curso sigue con los valores anteriores */
+	mock_sweep_psc = hal_mock.pwm_psc;
+	mock_sweep_arr = hal_mock.pwm_arr;
+	hal_mock.pwm_psc = psc;
+	hal_mock.pwm_arr = primero[0];
+	hal_mock.pwm_ccr = primero[2];
+	mock_sweep_pos = 0;
+	mock_sweep_acc = 0;
+	mock_sweep_on  = 1;
+
+	hal_mock.pwm_updates++;
+	hal_mock.reg_reads  += 4;	// TIM1_CR1 x2, DMA_CCR x2
+	hal_mock.reg_writes += 14;	// DMA: CCR x2, CPAR, CMAR, CNDTR, IFCR;
+					// TIM1: CR1 x2, PSC, ARR, CCR1, DCR, DIER;
+					// NVIC_ISER
+	hal_mock.pwm_reg_writes += 7;
+}
+
+void hal_pwm_sweep_stop(void)
+{
+	mock_sweep_on = 0;
+	hal_mock.reg_reads  += 2;	// TIM1_DIER, DMA_CCR
+	hal_mock.reg_writes += 4;	// TIM1_DIER, DMA_CCR, NVIC_ICER, NVIC_ICPR
+}
+
+void hal_mock_sweep_advance(uint32_t elapsed_us)
+{
+	if (!mock_sweep_on)
+		return;
+
+	mock_sweep_acc += (uint64_t)elapsed_us * (MOCK_TIM1_HZ / 1000000U);
+
+	while (mock_sweep_on) {
+		uint64_t len = (uint64_t)(mock_sweep_psc + 1) * (mock_sweep_arr + 1);
+		if (mock_sweep_acc < len)
+			break;
+		mock_sweep_acc -= len;
+
+		/* UEV: la precarga pasa a activo */
+		mock_sweep_psc = hal_mock.pwm_psc;
+		mock_sweep_arr = hal_mock.pwm_arr;
+
+		uint32_t f = (uint32_t)((MOCK_TIM1_HZ +
+			      (uint64_t)(mock_sweep_psc + 1) * (mock_sweep_arr + 1) / 2) /
+			     ((uint64_t)(mock_sweep_psc + 1) * (mock_sweep_arr + 1)));
+		hal_mock.sweep_periodos++;
+		if (f < hal_mock.sweep_f_min) hal_mock.sweep_f_min = f;
+		if (f > hal_mock.sweep_f_max) hal_mock.sweep_f_max = f;
+
+		/* Ráfaga del DMA: {ARR, RCR, CCR1} del período siguiente */
+		const uint16_t *p = &mock_sweep_buffer[3 * mock_sweep_pos++];
+		hal_mock.pwm_arr = p[0];
+		hal_mock.pwm_ccr = p[2];
+
+		/* HT o TC: mitad leída */
+		if (mock_sweep_pos % HAL_SWEEP_HALF_LEN == 0) {
+			unsigned half = mock_sweep_pos / HAL_SWEEP_HALF_LEN - 1;
+			mock_sweep_pos %= 2 * HAL_SWEEP_HALF_LEN;
+
+			hal_mock.reg_reads  += 2;	// DMA_ISR (HTIF, TCIF)
+			hal_mock.reg_writes += 1;	// DMA_IFCR
+			hal_sweep_half_ready(&mock_sweep_buffer[3 * half * HAL_SWEEP_HALF_LEN],
+					     HAL_SWEEP_HALF_LEN);
+		}
+	}
+}
+
+uint32_t hal_sweep_overruns(void)
+{
+	return 0;
+}
+#endif
+
+void hal_pwm_set(uint32_t psc, uint32_t period_arr, uint32_t ccr)
+{
+	hal_mock.pwm_psc = psc;
+	hal_mock.pwm_arr = period_arr;
+	hal_mock.pwm_ccr = ccr;
+	hal_mock.pwm_updates++;
+	hal_mock.reg_reads  += 2;	// TIM1_CR1 (UDIS a 1 y a 0)
+	hal_mock.reg_writes += 5;	// TIM1_CR1 x2, TIM1_PSC, TIM1_ARR, TIM1_CCR1
+	hal_mock.pwm_reg_writes += 5;
+}
+
+void hal_pwm_set_duty(uint32_t psc, uint32_t period_arr, uint32_t duty_q16)
+{
+#if HAL_PWM_DITHER
+	hal_mock.pwm_psc = psc;
+	hal_mock.pwm_arr = period_arr;
+	hal_mock.pwm_ccr = pwm_dither_fill(hal_mock.pwm_dither, HAL_PWM_DITHER_LOG2,
+					   period_arr + 1, duty_q16);
+	hal_mock.pwm_updates++;
+	hal_mock.reg_reads  += 2;	// TIM1_CR1 (UDIS a 1 y a 0)
+	hal_mock.reg_writes += 4;	// TIM1_CR1 x2, TIM1_PSC, TIM1_ARR
+	hal_mock.pwm_reg_writes += 4;
+#else
+	uint16_t ccr;
+	hal_pwm_set(psc, period_arr,
+		    pwm_dither_fill(&ccr, 0, period_arr + 1, duty_q16));
+#endif
+}
+
+void hal_led_toggle(void)
+{
+	hal_mock.led_toggles++;
+	hal_mock.reg_reads++;		// GPIOC_ODR
+	hal_mock.reg_writes++;		// GPIOC_BSRR
+}
@@ -0,0 +1,101 @@
+#ifndef HAL_MOCK_H
+#define HAL_MOCK_H
+
+#include <stdint.h>
+
+#include "hal.h"
+
+/*
+ * Implementación de hal.h para el host.
+ *
+ * Las entradas del ADC se fijan con hal_mock_set_adc() y el arnés hace
+ * avanzar el ADC/DMA simulado con hal_mock_adc_advance(), que entrega
+ * bloques a hal_adc_block_ready() al mismo ritmo que el hardware.
+ * Cada llamada a la HAL se registra y se contabilizan los accesos a
+ * registros que haría hal_opencm3.c para la misma operación, de modo que
+ * se puede medir el tráfico de periféricos de cada ciclo de control por
+ * separado del cálculo.
+ */
+struct hal_mock_state {
+	/* Entradas simuladas */
+	uint16_t adc_amp;
+	uint16_t adc_freq;
+
+	/* Últimos valores escritos */
+	uint32_t pwm_psc;
+	uint32_t pwm_arr;
+	uint32_t pwm_ccr;		// Con HAL_PWM_DITHER, el CCR redondeado
+#if HAL_PWM_DITHER
+	uint16_t pwm_dither[HAL_PWM_DITHER_LEN];	// Patrón del DMA
+#endif
+
+	/* Contadores de llamadas */
+	uint32_t adc_blocks;
+	uint64_t adc_pairs_produced;
+	uint32_t pwm_updates;
+	uint32_t led_toggles;
+
+#if HAL_PWM_DDS
+	/* Muestras del DDS consumidas por el DMA simulado */
+	uint64_t dds_samples;
+	uint32_t dds_cruces;		// Cruces ascendentes por el nivel medio
+	uint16_t dds_min, dds_max;	// CCR1 mínimo y máximo
+#endif
+
+#if HAL_PWM_SWEEP
+	/* Períodos del barrido ejecutados por el TIM1 simulado */
+	uint32_t sweep_periodos;
+	uint32_t sweep_f_min, sweep_f_max;	// Hz (redondeados)
+#endif
+
+	/* Accesos a registros de periféricos equivalentes en el target */
+	uint32_t reg_reads;
+	uint32_t reg_writes;
+	uint32_t pwm_reg_writes;	// Las del TIM1 en pwm_updates (incluidas)
+};
+
+extern struct hal_mock_state hal_mock;
+
+/**
+ * @brief Fija las muestras crudas (12 bits) que producirá el ADC simulado.
+ */
+void hal_mock_set_adc(uint16_t amp, uint16_t freq);
+
+/**
+ * @brief Avanza el ADC/DMA simulado 'elapsed_us' microsegundos.
+ *
+ * Produce HAL_ADC_PAIR_RATE_HZ pares por segundo y llama a
+ * hal_adc_block_ready() por cada medio búfer completo, como la ISR del
+ * DMA. Debe llamarse desde contexto de "interrupción" (p. ej. el tick).
+ */
+void hal_mock_adc_advance(uint32_t elapsed_us);
+
+#if HAL_PWM_DDS
+/**
+ * @brief Avanza 'elapsed_us' microsegundos el TIM1/DMA del DDS simulado.
+ *
+ * Consume HAL_DDS_FS_HZ muestras por segundo y llama a
+ * hal_dds_half_ready() por cada mitad leída, como la ISR del DMA1
+ * Canal 5. Debe llamarse desde contexto de "interrupción".
+ */
+void hal_mock_dds_advance(uint32_t elapsed_us);
+#endif
+
+#if HAL_PWM_SWEEP
+/**
+ * @brief Avanza 'elapsed_us' microsegundos el TIM1/DMA del barrido.
+ *
+ * Con un barrido en marcha recorre los períodos uno a uno (cada UEV pasa
+ * la precarga a activo y el DMA carga el período siguiente del búfer) y
+ * llama a hal_sweep_half_ready() por cada mitad leída. Debe llamarse
+ * desde contexto de "interrupción".
+ */
+void hal_mock_sweep_advance(uint32_t elapsed_us);
+#endif
+
+/**
+ * @brief Pone a cero los contadores (no las entradas ni los últimos valores).
+ */
+void hal_mock_reset_counters(void);
+
+#endif // HAL_MOCK_H
@@ -0,0 +1,444 @@
+/*
+ * Arnés de simulación en el host (Linux).
+ *
+ * Ejecuta las mismas tareas que main.c sobre el puerto host de FreeRTOS
+ * (rtos/port_host.c) con un tick virtual: el tiempo simulado avanza tan
+ * rápido como lo permita el host, o al ritmo pedido con -x.
+ *
+ * Uso: main_host [-t segundos] [-x factor] [-a volts] [-f volts] [-l escalones]
+ *		   [-p tau_ms] [-s f0,f1,ms,lin|log] [-T fichero]
+ *	-t	Tiempo simulado a ejecutar (por defecto 10 s).
+ *	-x	Velocidad respecto al tiempo real (0 = sin límite, por defecto).
+ *	-a	Tensión simulada en el pin de Amplitud (PA0).
+ *	-f	Tensión simulada en el pin de Frecuencia (PA1).
+ *	-l	Prueba de latencia: aplica N escalones entre (-a, -f) y
+ *		(-a/2, -f/2) y mide el tiempo hasta que cambia el PWM y hasta
+ *		que llega a su valor final. Resolución: 1 tick.
+ *	-p	Planta simulada para el lazo cerrado (CONTROL_PID_AMP/FREQ):
+ *		las entradas pasan a ser la realimentación del PWM, a través
+ *		de un filtro de primer orden de constante tau_ms. -a y -f
+ *		dan el valor inicial.
+ *	-s	Con HAL_PWM_SWEEP: barrido de f0 a f1 Hz en 'ms' milisegundos,
+ *		lineal o logarítmico, desde el arranque. Informa del rango y
+ *		los períodos que ejecutó el TIM1 simulado y de cuándo se paró
+ *		el DMA (resolución: 1 tick).
+ *	-T	Con TRAZA: escribe la traza del scheduler en el fichero
+ *		(ver traza.h), vaciando el búfer en cada tick. Para verla:
+ *		traza2json fichero > traza.json, y abrirlo en
+ *		ui.perfetto.dev o chrome://tracing.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_tasks.h"
+#include "banco_colas.h"
+#include "banco_mutex.h"
+#include "control.h"
+#include "hal_mock.h"
+#include "monitor.h"
+#include "rtstats.h"
+#include "traza.h"
+
+static TickType_t xSimTicks;
+
+#if HAL_PWM_SWEEP
+static int barrido_pedido;
+static TickType_t barrido_fin;		// Tick en que se paró el DMA
+#endif
+
+#if TRAZA
+static FILE *traza_fichero;		// -T
+static unsigned long traza_registros;
+
+static void traza_escribir(const void *datos, size_t n, void *ctx)
+{
+	fwrite(datos, 1, n, (FILE *)ctx);
+}
+#endif
+
+/* ========= Prueba de latencia entrada -> PWM (-l) ========= */
+
+#define LAT_PERIODO	150	// Ticks entre escalones (600ms)
+#define LAT_DESFASE	7	// Desfase variable para barrer la fase
+
+static struct {
+	unsigned steps;			// Escalones pedidos
+	unsigned done;			// Escalones medidos
+	uint16_t level[2][2];		// {amp, freq} de cada nivel
+	int cur;			// Nivel actual
+	TickType_t next;		// Tick del próximo escalón
+	TickType_t t_step;		// Tick del escalón en curso
+	struct control_output before;	// PWM antes del escalón
+	struct control_output target;	// PWM final esperado
+	int wait_first, wait_settle;
+	uint64_t sum_first, sum_settle;	// En ticks
+	TickType_t max_first, max_settle;
+} lat;
+
+static int __pwm_equals(const struct control_output *o)
+{
+	return hal_mock.pwm_psc == o->psc && hal_mock.pwm_arr == o->period_arr &&
+	       hal_mock.pwm_ccr == o->ccr;
+}
+
+static void latency_tick(TickType_t now)
+{
+	if (lat.wait_first && !__pwm_equals(&lat.before)) {
+		TickType_t d = now - lat.t_step;
+		lat.sum_first += d;
+		if (d > lat.max_first) lat.max_first = d;
+		lat.wait_first = 0;
+	}
+	if (lat.wait_settle && __pwm_equals(&lat.target)) {
+		TickType_t d = now - lat.t_step;
+		lat.sum_settle += d;
+		if (d > lat.max_settle) lat.max_settle = d;
+		lat.wait_settle = 0;
+		lat.done++;
+	}
+
+	if (now == lat.next && lat.done < lat.steps && !lat.wait_settle) {
+		lat.cur ^= 1;
+		hal_mock_set_adc(lat.level[lat.cur][0], lat.level[lat.cur][1]);
+		control_map(lat.level[lat.cur][0], lat.level[lat.cur][1], &lat.target);
+		lat.before.psc = hal_mock.pwm_psc;
+		lat.before.period_arr = hal_mock.pwm_arr;
+		lat.before.ccr = hal_mock.pwm_ccr;
+		lat.t_step = now;
+		lat.wait_first = lat.wait_settle = 1;
+		lat.next = now + LAT_PERIODO + (lat.done % LAT_DESFASE);
+	}
+}
+
+static uint16_t __volts_to_u12(double volts)
+{
+	if (volts <= 0.0) return 0;
+	if (volts >= VREF_VOLTS) return 4095;
+	return (uint16_t)(volts * 4095.0 / VREF_VOLTS + 0.5);
+}
+
+/* ========= Planta simulada para el lazo cerrado (-p) ========= */
+
+static struct {
+	double alpha;			// 1 tick / tau (0 = sin planta)
+	double amp_v, freq_v;		// Salidas de los sensores (V)
+} plant;
+
+/*
+ * Detector de amplitud: duty * VREF (2.0 V con el 60.6%).
+ * Convertidor f-V: CONTROL_SETPOINT_MV a CONTROL_TARGET_FREQ_HZ.
+ * Los dos con la misma constante de tiempo.
+ */
+static void plant_tick(void)
+{
+	double arr = (double)hal_mock.pwm_arr + 1.0;
+	double period = ((double)hal_mock.pwm_psc + 1.0) * arr;
+	double amp_v  = (double)hal_mock.pwm_ccr / arr * VREF_VOLTS;
+	double freq_v = (double)CONTROL_TIM_CLOCK_HZ / period
+		      / CONTROL_TARGET_FREQ_HZ * CONTROL_SETPOINT_MV / 1000.0;
+
+	plant.amp_v  += (amp_v - plant.amp_v) * plant.alpha;
+	plant.freq_v += (freq_v - plant.freq_v) * plant.alpha;
+	hal_mock_set_adc(__volts_to_u12(plant.amp_v), __volts_to_u12(plant.freq_v));
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t pxTask, char *pcTaskName);
+
+void
+vApplicationStackOverflowHook(TaskHandle_t pxTask, char *pcTaskName) {
+	(void)pxTask;
+	fprintf(stderr, "Desbordamiento de pila en la tarea %s\n", pcTaskName);
+	abort();
+}
+
+/**
+ * @brief Se ejecuta en cada tick (ISR del SysTick): avanza el ADC/DMA
+ *        simulado y termina la simulación.
+ */
+void
+vApplicationTickHook(void) {
+	TickType_t now = xTaskGetTickCountFromISR();
+
+	if (lat.steps)
+		latency_tick(now);
+	if (plant.alpha > 0.0)
+		plant_tick();
+
+	hal_mock_adc_advance(1000000UL / configTICK_RATE_HZ);
+#if HAL_PWM_DDS
+	hal_mock_dds_advance(1000000UL / configTICK_RATE_HZ);
+#endif
+#if HAL_PWM_SWEEP
+	hal_mock_sweep_advance(1000000UL / configTICK_RATE_HZ);
+	if (barrido_pedido && !barrido_fin && !barrido_activo())
+		barrido_fin = now;
+#endif
+#if TRAZA
+	if (traza_fichero)
+		traza_registros += traza_drenar(traza_escribir, traza_fichero);
+#endif
+
+	if (now >= xSimTicks)
+		vTaskEndScheduler();
+}
+
+int
+main(int argc, char **argv) {
+	double sim_seconds = 10.0;
+	double speedup = 0.0;
+	double amp_volts = 2.0, freq_volts = 2.0;
+	double tau_ms = 0.0;
+	int opt;
+#if HAL_PWM_SWEEP
+	struct sweep_config barrido = { .duty_q16 = 32768 };
+	char ley[4];
+#endif
+
+	while ((opt = getopt(argc, argv, "t:x:a:f:l:p:s:T:")) != -1) {
+		switch (opt) {
+		case 't': sim_seconds = atof(optarg); break;
+		case 'x': speedup = atof(optarg); break;
+		case 'a': amp_volts = atof(optarg); break;
+		case 'f': freq_volts = atof(optarg); break;
+		case 'l': lat.steps = (unsigned)atoi(optarg); break;
+		case 'p': tau_ms = atof(optarg); break;
+#if TRAZA
+		case 'T':
+			if ((traza_fichero = fopen(optarg, "wb")) != NULL)
+				break;
+			perror(optarg);
+			return 2;
+#endif
+#if HAL_PWM_SWEEP
+		case 's':
+			if (sscanf(optarg, "%u,%u,%u,%3s", &barrido.f_inicio_hz,
+				   &barrido.f_fin_hz, &barrido.duracion_ms, ley) == 4) {
+				barrido.ley = ley[1] == 'o' ? SWEEP_LOG : SWEEP_LINEAL;
+				barrido_pedido = 1;
+				break;
+			}
+			/* fall through: mal escrito, al uso */
+#endif
+		default:
+			fprintf(stderr, "uso: %s [-t segundos] [-x factor] "
+				"[-a volts] [-f volts] [-l escalones] "
+				"[-p tau_ms] [-s f0,f1,ms,lin|log] "
+				"[-T fichero]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	xSimTicks = (TickType_t)(sim_seconds * configTICK_RATE_HZ);
+	hal_mock_set_adc(__volts_to_u12(amp_volts), __volts_to_u12(freq_volts));
+
+	if (tau_ms > 0.0) {
+		double tick_ms = 1000.0 / configTICK_RATE_HZ;
+		plant.alpha = tick_ms < tau_ms ? tick_ms / tau_ms : 1.0;
+		plant.amp_v = amp_volts;
+		plant.freq_v = freq_volts;
+	}
+
+	if (lat.steps) {
+		lat.level[0][0] = __volts_to_u12(amp_volts);
+		lat.level[0][1] = __volts_to_u12(freq_volts);
+		lat.level[1][0] = __volts_to_u12(amp_volts / 2);
+		lat.level[1][1] = __volts_to_u12(freq_volts / 2);
+		lat.next = LAT_PERIODO;	// Tras asentarse el valor inicial
+		xSimTicks = (TickType_t)(lat.steps + 2) * (LAT_PERIODO + LAT_DESFASE);
+	}
+
+#if HAL_PWM_SWEEP
+	hal_mock_reset_counters();
+	if (barrido_pedido && barrido_iniciar(&barrido) != 0) {
+		fprintf(stderr, "barrido no realizable\n");
+		return 2;
+	}
+#endif
+
+	if (speedup > 0.0)
+		vPortHostSetTickPacing((uint32_t)(1e9 / configTICK_RATE_HZ / speedup));
+
+	/* --- Creación de Tareas (mismas prioridades y pilas que main.c) --- */
+	TAREA_CREAR(vTaskLed, "LED", PILA_LED,
+		    configMAX_PRIORITIES - 3, NULL);
+	TAREA_CREAR(vTaskReadAnalog, "ADC", PILA_ADC,
+		    configMAX_PRIORITIES - 1, &xTaskAdcHandle);
+	TAREA_CREAR(vTaskControlPWM, "PWM_Ctrl", PILA_PWM,
+		    configMAX_PRIORITIES - 2, &xTaskPwmCtrlHandle);
+#if MONITOR
+	TAREA_CREAR(vTaskMonitor, "Monitor", PILA_MONITOR,
+		    PRIORIDAD_MONITOR, NULL);
+#endif
+#if BANCO_COLAS
+	TAREA_CREAR(vTaskBancoColas, "BancoColas", PILA_BANCO_COLAS,
+		    PRIORIDAD_BANCO_COLAS, NULL);
+#endif
+#if BANCO_MUTEX
+	TAREA_CREAR(vTaskBancoMutex, "BancoMutex", PILA_BANCO_MUTEX,
+		    PRIORIDAD_BANCO_MUTEX, NULL);
+#endif
+
+#if RTSTATS
+	rtstats_init();
+#endif
+#if TRAZA
+	traza_init();
+#endif
+
+	struct timespec t0, t1;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+
+	/* Vuelve cuando el tick hook llama a vTaskEndScheduler() */
+	vTaskStartScheduler();
+
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	double wall = (double)(t1.tv_sec - t0.tv_sec)
+		    + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+	double simulated = (double)xTaskGetTickCount() / configTICK_RATE_HZ;
+
+	printf("tiempo simulado : %.3f s (%lu ticks)\n",
+	       simulated, (unsigned long)xTaskGetTickCount());
+	printf("tiempo real     : %.3f s (x%.0f)\n",
+	       wall, wall > 0.0 ? simulated / wall : 0.0);
+	printf("LED             : %lu conmutaciones\n",
+	       (unsigned long)hal_mock.led_toggles);
+	printf("TIM1            : PSC=%lu ARR=%lu CCR1=%lu (%lu actualizaciones)\n",
+	       (unsigned long)hal_mock.pwm_psc,
+	       (unsigned long)hal_mock.pwm_arr,
+	       (unsigned long)hal_mock.pwm_ccr,
+	       (unsigned long)hal_mock.pwm_updates);
+	struct adc_totals totals;
+	adc_get_totals(&totals);
+	printf("ADC producidas  : %.0f muestras/s (%lu bloques de %u pares)\n",
+	       2.0 * (double)hal_mock.adc_pairs_produced / simulated,
+	       (unsigned long)hal_mock.adc_blocks, HAL_ADC_BLOCK_PAIRS);
+	printf("ADC consumidas  : %.0f muestras/s (%lu bloques perdidos)\n",
+	       2.0 * (double)totals.pairs / simulated,
+	       (unsigned long)hal_adc_overruns());
+#if HAL_PWM_DDS
+	printf("DDS             : %.1f Hz medidos, CCR1 %u..%u de %u "
+	       "(%.0f muestras/s)\n",
+	       (double)hal_mock.dds_cruces / simulated,
+	       hal_mock.dds_min, hal_mock.dds_max, HAL_DDS_PERIOD,
+	       (double)hal_mock.dds_samples / simulated);
+#endif
+#if HAL_PWM_SWEEP
+	if (barrido_pedido)
+		printf("barrido         : %lu -> %lu Hz %s en %lu ms: %lu períodos, "
+		       "%lu..%lu Hz, DMA parado a los %.0f ms (%lu mitades perdidas)\n",
+		       (unsigned long)barrido.f_inicio_hz,
+		       (unsigned long)barrido.f_fin_hz,
+		       barrido.ley == SWEEP_LOG ? "log" : "lineal",
+		       (unsigned long)barrido.duracion_ms,
+		       (unsigned long)hal_mock.sweep_periodos,
+		       (unsigned long)hal_mock.sweep_f_min,
+		       (unsigned long)hal_mock.sweep_f_max,
+		       1000.0 * barrido_fin / configTICK_RATE_HZ,
+		       (unsigned long)hal_sweep_overruns());
+#endif
+	printf("registros       : %lu lecturas, %lu escrituras",
+	       (unsigned long)hal_mock.reg_reads,
+	       (unsigned long)hal_mock.reg_writes);
+	/* Sólo las del TIM1: las de las ISR del DMA no dependen del control */
+	if (hal_mock.pwm_updates)
+		printf(" (%.2f del TIM1 por actualización del PWM)",
+		       (double)hal_mock.pwm_reg_writes / hal_mock.pwm_updates);
+	printf("\n");
+
+#if RTSTATS
+	{
+		struct rtstats_info info[RTSTATS_MAX_TAREAS + 1];
+		uint8_t volcado[RTSTATS_VOLCADO_MAX];
+		unsigned n = rtstats_leer(info, RTSTATS_MAX_TAREAS + 1);
+		size_t bytes = rtstats_volcar(volcado, sizeof(volcado));
+		uint64_t suma = 0;
+
+		for (unsigned i = 0; i < n; ++i)
+			suma += info[i].total;
+		printf("CPU por tarea   : ciclos del TSC, %lu subventanas, "
+		       "volcado de %lu bytes\n", (unsigned long)rtstats.subventanas,
+		       (unsigned long)bytes);
+		for (unsigned i = 0; i < n; ++i)
+			printf("  %-13s : %6.2f%% del total, %6.2f%% en la "
+			       "ventana, ráfaga máx. %lu ciclos\n",
+			       info[i].tarea ? pcTaskGetName(info[i].tarea) : "(otros)",
+			       suma ? 100.0 * (double)info[i].total / (double)suma : 0.0,
+			       info[i].carga / 100.0, (unsigned long)info[i].max_rafaga);
+	}
+#endif
+
+#if MONITOR
+	{
+		struct monitor_registro r;
+		monitor_leer(&r);
+		printf("monitor         : %u vueltas, heap libre %lu bytes "
+		       "(mínimo %lu), %u bytes de registro\n", r.vueltas,
+		       (unsigned long)r.heap_libre, (unsigned long)r.heap_min,
+		       (unsigned)sizeof(r));
+		/* El registro dice el uxTCBNumber; el nombre, por su handle */
+		for (unsigned i = 0; i < r.tareas; ++i)
+			if (r.pila[i].tarea && r.pila[i].ini)
+				printf("  %-13s : %u palabras de pila sin usar\n",
+				       pcTaskGetName(monitor.pila[r.pila[i].tarea].tarea),
+				       r.pila[i].libre);
+	}
+#endif
+
+#if BANCO_COLAS
+	if (banco_colas.hecho) {
+		printf("colas           : ciclos por elemento (lotes de %u)\n",
+		       BANCO_COLAS_LOTE);
+		for (unsigned m = 0; m < BANCO_MODOS; ++m) {
+			printf("  %-16s :", banco_colas_nombre[m]);
+			for (unsigned t = 0; t < BANCO_COLAS_TAMANOS; ++t)
+				printf(" %4lu (%lu B)", (unsigned long)banco_colas.tam[t].ciclos[m],
+				       (unsigned long)banco_colas.tam[t].bytes);
+			printf("\n");
+		}
+	}
+#endif
+
+#if BANCO_MUTEX
+	if (banco_mutex.hecho) {
+		printf("mutex           : ciclos libre (tomar + dar) / disputado (vuelta)\n");
+		for (unsigned t = 0; t < BANCO_MUTEX_TIPOS; ++t)
+			printf("  %-18s : %4lu / %lu\n", banco_mutex_nombre[t],
+			       (unsigned long)banco_mutex.libre[t],
+			       (unsigned long)banco_mutex.disputado[t]);
+		if (banco_mutex.herencia_mal)
+			printf("  ¡%lu vueltas sin herencia de prioridad!\n",
+			       (unsigned long)banco_mutex.herencia_mal);
+	}
+#endif
+
+#if TRAZA
+	if (traza_fichero) {
+		traza_registros += traza_drenar(traza_escribir, traza_fichero);
+		fclose(traza_fichero);
+		printf("traza           : %lu registros escritos de %lu eventos "
+		       "(búfer de %u)\n", traza_registros,
+		       (unsigned long)traza.pos, TRAZA_LEN);
+	}
+#endif
+
+	if (plant.alpha > 0.0)
+		printf("planta          : amplitud %.3f V, frecuencia %.3f V "
+		       "(setpoint %.3f V)\n", plant.amp_v, plant.freq_v,
+		       CONTROL_SETPOINT_MV / 1000.0);
+
+	if (lat.steps) {
+		const double ms = 1000.0 / configTICK_RATE_HZ;
+		unsigned n = lat.done ? lat.done : 1;
+		printf("latencia        : %u escalones, 1a reacción media %.1f ms "
+		       "(máx %.0f), valor final medio %.1f ms (máx %.0f)\n",
+		       lat.done, ms * (double)lat.sum_first / n,
+		       ms * lat.max_first, ms * (double)lat.sum_settle / n,
+		       ms * lat.max_settle);
+	}
+	return 0;
+}
@@ -0,0 +1,415 @@
+/*
+ * Pila de peor caso por tarea a partir del grafo de llamadas estático.
+ *
+ * Uso: pilas [-d listado] [-m bytes] [-o pilas.h] [-e NOMBRE=función]...
+ *	      [-i isr]... fichero.ci...
+ *
+ *	fichero.ci	Grafo de cada unidad de compilación, de gcc
+ *			-fstack-usage -fcallgraph-info=su: marco de cada
+ *			función y sus llamadas (ya con lo que se inlinea).
+ *	-d	"objdump -d" del ELF: marco y llamadas de lo que no tiene
+ *		.ci (rutinas soft-float de libgcc, libopencm3, newlib),
+ *		de los push/stmdb/sub sp y bl/b.w del prólogo (Thumb-2).
+ *	-m	Bytes que cada tarea tiene que dejar libres además de su
+ *		cadena de llamadas más profunda (Cortex-M3: marco de
+ *		excepción de 8 palabras + 1 de alineación, y r4-r11 que
+ *		guarda PendSV: 68). Las ISR corren en la pila principal.
+ *	-e	Función de entrada de una tarea, y nombre de la constante
+ *		(en palabras, con -m) que se escribe en -o.
+ *	-i	ISR: se informa de su peor caso (pila principal).
+ *
+ * El resultado es una cota inferior (y se avisa) si en el camino hay
+ * llamadas indirectas, recursión, marcos dinámicos sin cota o funciones
+ * de las que no hay datos.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_FUNCIONES	8192
+#define MAX_ENTRADAS	32
+#define LINEA		1024
+
+/* Motivos por los que un peor caso es sólo una cota inferior */
+#define F_INDIRECTA	0x01	// Llamada por puntero
+#define F_RECURSION	0x02
+#define F_DINAMICA	0x04	// alloca / VLA sin cota
+#define F_SIN_DATOS	0x08	// Ni .ci ni listado
+
+struct funcion {
+	char *nombre;
+	long marco;		// Bytes; -1 = sin datos
+	unsigned flags;
+	int *llama;		// Índices de las llamadas
+	unsigned n_llama, cap_llama;
+	/* Peor caso (recorrido) */
+	int estado;		// 0 = pendiente, 1 = en curso, 2 = hecho
+	long peor;
+	unsigned peor_flags;
+	int siguiente;		// Llamada del camino más profundo, o -1
+};
+
+static struct funcion fn[MAX_FUNCIONES];
+static unsigned n_fn;
+
+static int __buscar(const char *nombre)
+{
+	for (unsigned i = 0; i < n_fn; ++i)
+		if (strcmp(fn[i].nombre, nombre) == 0)
+			return (int)i;
+	return -1;
+}
+
+static int __funcion(const char *nombre)
+{
+	int i = __buscar(nombre);
+
+	if (i >= 0)
+		return i;
+	if (n_fn == MAX_FUNCIONES) {
+		fprintf(stderr, "demasiadas funciones\n");
+		exit(1);
+	}
+	fn[n_fn].nombre = strdup(nombre);
+	fn[n_fn].marco = -1;
+	fn[n_fn].siguiente = -1;
+	return (int)n_fn++;
+}
+
+static void __llamada(int de, int a)
+{
+	struct funcion *f = &fn[de];
+
+	for (unsigned i = 0; i < f->n_llama; ++i)
+		if (f->llama[i] == a)
+			return;
+	if (f->n_llama == f->cap_llama) {
+		f->cap_llama = f->cap_llama ? 2 * f->cap_llama : 8;
+		f->llama = realloc(f->llama, f->cap_llama * sizeof(int));
+	}
+	f->llama[f->n_llama++] = a;
+}
+
+/* Nombre sin la ruta de las funciones static ("ruta/x.c:f" -> "f") */
+static const char *__corto(const char *nombre)
+{
+	const char *p = strrchr(nombre, ':');
+	return p ? p + 1 : nombre;
+}
+
+/* Una entrada por nombre corto, si no hay una exacta */
+static int __entrada(const char *nombre)
+{
+	int i = __buscar(nombre);
+
+	for (unsigned j = 0; i < 0 && j < n_fn; ++j)
+		if (strcmp(__corto(fn[j].nombre), nombre) == 0)
+			i = (int)j;
+	return i;
+}
+
+/* Copia en 'v' el valor entre comillas de 'campo: "..."' */
+static int __campo(const char *linea, const char *campo, char *v, size_t len)
+{
+	const char *p = strstr(linea, campo);
+	size_t n = 0;
+
+	if (p == NULL || (p = strchr(p + strlen(campo), '"')) == NULL)
+		return 0;
+	for (++p; *p && *p != '"' && n + 1 < len; ++p)
+		v[n++] = *p;
+	v[n] = '\0';
+	return 1;
+}
+
+/* -fcallgraph-info=su: líneas "node: {...}" y "edge: {...}" */
+static void __leer_ci(const char *fichero)
+{
+	FILE *f = fopen(fichero, "r");
+	char linea[LINEA], a[LINEA], b[LINEA];
+
+	if (f == NULL) {
+		perror(fichero);
+		exit(1);
+	}
+	while (fgets(linea, sizeof(linea), f)) {
+		if (strncmp(linea, "node:", 5) == 0 && __campo(linea, "title:", a, sizeof(a))) {
+			int i = __funcion(a);
+			const char *bytes;
+
+			/* label: "nombre\nfichero:línea:col\nN bytes (static)" */
+			if (!__campo(linea, "label:", b, sizeof(b)) ||
+			    (bytes = strstr(b, " bytes (")) == NULL)
+				continue;	// Externa: definida en otro .ci
+			while (bytes > b && bytes[-1] >= '0' && bytes[-1] <= '9')
+				--bytes;
+			fn[i].marco = strtol(bytes, NULL, 10);
+			if (strstr(bytes, "dynamic") && !strstr(bytes, "bounded"))
+				fn[i].flags |= F_DINAMICA;
+		} else if (strncmp(linea, "edge:", 5) == 0 &&
+			   __campo(linea, "sourcename:", a, sizeof(a)) &&
+			   __campo(linea, "targetname:", b, sizeof(b))) {
+			int de = __funcion(a);
+
+			if (strcmp(b, "__indirect_call") == 0)
+				fn[de].flags |= F_INDIRECTA;
+			else
+				__llamada(de, __funcion(b));
+		}
+	}
+	fclose(f);
+}
+
+/* Registros de una lista "{r4, r5, lr}" (o "{r4-r7}") */
+static long __registros(const char *p)
+{
+	long n = 0;
+	int a, b;
+
+	if ((p = strchr(p, '{')) == NULL)
+		return 0;
+	while (*p != '}' && *p != '\0') {
+		p += strspn(p + 1, " ") + 1;
+		if (sscanf(p, "r%d-r%d", &a, &b) == 2 && b >= a)
+			n += b - a + 1;
+		else if (*p != '}')
+			n++;
+		p += strcspn(p, ",}");
+	}
+	return n;
+}
+
+/*
+ * objdump -d (Thumb-2). Llamadas: los bl/blx y los b/b.w a otro símbolo
+ * (llamada de cola) de todas las funciones, porque las de libgcc que
+ * mete el compilador (__aeabi_*) no salen en los .ci. Marco: sólo de las
+ * que no lo tienen en ningún .ci, sumando todos sus push y sub sp (en la
+ * práctica, el prólogo).
+ */
+static void __leer_listado(const char *fichero)
+{
+	FILE *f = fopen(fichero, "r");
+	char linea[LINEA], sim[LINEA];
+	int actual = -1;	// Función en curso del listado
+	int marco = 0;		// Su marco sale del listado
+	unsigned long dir;
+
+	if (f == NULL) {
+		perror(fichero);
+		exit(1);
+	}
+	while (fgets(linea, sizeof(linea), f)) {
+		/* "08000abc <__aeabi_fmul>:" */
+		if (sscanf(linea, "%lx <%1000[^>]>:", &dir, sim) == 2) {
+			int i = __entrada(sim);
+			actual = i >= 0 ? i : __funcion(sim);
+			marco = fn[actual].marco < 0;
+			if (marco)
+				fn[actual].marco = 0;
+			continue;
+		}
+		if (actual < 0)
+			continue;
+
+		/* " 8000abc:\tb5f0      \tpush\t{r4, r5, lr}" */
+		char *ins = strchr(linea, '\t');
+		if (ins == NULL || (ins = strchr(ins + 1, '\t')) == NULL)
+			continue;
+		++ins;
+
+		char op[32];
+		long n;
+		if (sscanf(ins, "%31s", op) != 1)
+			continue;
+		if (marco && (strcmp(op, "push") == 0 || strcmp(op, "push.w") == 0 ||
+			      (strncmp(op, "stmdb", 5) == 0 && strstr(ins, "sp!"))))
+			fn[actual].marco += 4 * __registros(ins);
+		else if (marco && strncmp(op, "str", 3) == 0 && strstr(ins, "[sp, #-") &&
+			 strstr(ins, "]!")) {
+			if (sscanf(strstr(ins, "[sp, #-") + 7, "%ld", &n) == 1)
+				fn[actual].marco += n;
+		} else if (marco && (strcmp(op, "sub") == 0 || strcmp(op, "sub.w") == 0 ||
+				     strcmp(op, "subw") == 0) && strstr(ins, "\tsp, ")) {
+			const char *p = strrchr(ins, '#');
+			if (p && sscanf(p + 1, "%ld", &n) == 1)
+				fn[actual].marco += n;
+		} else if (strcmp(op, "blx") == 0 && !strchr(ins, '<')) {
+			fn[actual].flags |= F_INDIRECTA;	// blx rN
+		} else if (strcmp(op, "bl") == 0 || strcmp(op, "blx") == 0 ||
+			   strcmp(op, "b") == 0 || strcmp(op, "b.w") == 0 ||
+			   strcmp(op, "b.n") == 0) {
+			/* "bl\t8000c1c <__aeabi_fadd>"; "<f+0x12>" es un salto local */
+			const char *p = strchr(ins, '<');
+			if (p && sscanf(p + 1, "%1000[^>]", sim) == 1 && !strchr(sim, '+') &&
+			    strcmp(sim, __corto(fn[actual].nombre)) != 0) {
+				int a = __entrada(sim);
+				__llamada(actual, a >= 0 ? a : __funcion(sim));
+			}
+		}
+	}
+	fclose(f);
+}
+
+static void __peor(int i)
+{
+	struct funcion *f = &fn[i];
+
+	if (f->estado == 2)
+		return;
+	f->estado = 1;
+	f->peor = 0;
+	f->peor_flags = f->flags;
+	for (unsigned j = 0; j < f->n_llama; ++j) {
+		struct funcion *c = &fn[f->llama[j]];
+		if (c->estado == 1) {
+			f->peor_flags |= F_RECURSION;
+			continue;
+		}
+		__peor(f->llama[j]);
+		f->peor_flags |= c->peor_flags;
+		if (c->peor > f->peor) {
+			f->peor = c->peor;
+			f->siguiente = f->llama[j];
+		}
+	}
+	if (f->marco < 0)
+		f->peor_flags |= F_SIN_DATOS;
+	else
+		f->peor += f->marco;
+	f->estado = 2;
+}
+
+/* Motivos de cota inferior, y las funciones sin datos del grafo */
+static void __avisos(FILE *s, unsigned flags)
+{
+	static const char *motivo[] = {
+		"llamada indirecta", "recursión", "marco dinámico", "sin datos",
+	};
+	const char *sep = " (cota inferior: ";
+
+	for (unsigned b = 0; b < 4; ++b)
+		if (flags & (1U << b)) {
+			fprintf(s, "%s%s", sep, motivo[b]);
+			sep = ", ";
+		}
+	if (flags)
+		fputs(")", s);
+}
+
+static void __camino(FILE *s, int i)
+{
+	for (const char *sep = ""; i >= 0; i = fn[i].siguiente, sep = " > ")
+		fprintf(s, "%s%s (%ld)", sep, __corto(fn[i].nombre), fn[i].marco);
+}
+
+int main(int argc, char **argv)
+{
+	const char *listado = NULL, *salida = NULL;
+	const char *tarea[MAX_ENTRADAS], *isr[MAX_ENTRADAS];
+	unsigned n_tareas = 0, n_isr = 0;
+	long extra = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "d:m:o:e:i:")) != -1) {
+		switch (opt) {
+		case 'd': listado = optarg; break;
+		case 'm': extra = atol(optarg); break;
+		case 'o': salida = optarg; break;
+		case 'e':
+			if (n_tareas < MAX_ENTRADAS && strchr(optarg, '=')) {
+				tarea[n_tareas++] = optarg;
+				break;
+			}
+			goto uso;
+		case 'i':
+			if (n_isr < MAX_ENTRADAS) {
+				isr[n_isr++] = optarg;
+				break;
+			}
+			/* fall through */
+		default:
+		uso:
+			fprintf(stderr, "uso: %s [-d listado] [-m bytes] [-o pilas.h] "
+				"[-e NOMBRE=función]... [-i isr]... fichero.ci...\n", argv[0]);
+			return 2;
+		}
+	}
+
+	for (int i = optind; i < argc; ++i)
+		__leer_ci(argv[i]);
+	if (listado)
+		__leer_listado(listado);
+
+	FILE *h = NULL;
+	if (salida) {
+		if ((h = fopen(salida, "w")) == NULL) {
+			perror(salida);
+			return 1;
+		}
+		fprintf(h, "/* Generado por host/pilas (make pilas): no editar */\n"
+			"#ifndef PILAS_H\n#define PILAS_H\n\n"
+			"/* Palabras de pila de peor caso por tarea, con %ld bytes de "
+			"marco */\n", extra);
+	}
+
+	int error = 0;
+	printf("tarea            bytes  +marco  palabras  camino más profundo (bytes)\n");
+	for (unsigned t = 0; t < n_tareas; ++t) {
+		const char *igual = strchr(tarea[t], '=');
+		char nombre[64];
+		int i = __entrada(igual + 1);
+
+		snprintf(nombre, sizeof(nombre), "%.*s", (int)(igual - tarea[t]), tarea[t]);
+		if (i < 0) {
+			fprintf(stderr, "%s: no está en el grafo\n", igual + 1);
+			error = 1;
+			continue;
+		}
+		__peor(i);
+
+		const long palabras = (fn[i].peor + extra + 3) / 4;
+		printf("%-14s %7ld %7ld %9ld  ", nombre, fn[i].peor, extra, palabras);
+		__camino(stdout, i);
+		__avisos(stdout, fn[i].peor_flags);
+		printf("\n");
+
+		if (h) {
+			fprintf(h, "\n/* %s: %ld bytes", __corto(fn[i].nombre), fn[i].peor);
+			__avisos(h, fn[i].peor_flags);
+			fprintf(h, " */\n#define %s_CALCULADA\t%ld\n", nombre, palabras);
+		}
+	}
+
+	for (unsigned t = 0; t < n_isr; ++t) {
+		int i = __entrada(isr[t]);
+		if (i < 0) {
+			fprintf(stderr, "%s: no está en el grafo\n", isr[t]);
+			error = 1;
+			continue;
+		}
+		__peor(i);
+		printf("%-14s %7ld %7s %9s  ", "(ISR)", fn[i].peor, "-", "-");
+		__camino(stdout, i);
+		__avisos(stdout, fn[i].peor_flags);
+		printf("\n");
+	}
+
+	/* Lo que falta para que las cotas sean exactas */
+	for (unsigned f = 0; f < 2; ++f) {
+		const char *sep = f ? "llamadas indirectas en: " : "sin datos: ";
+		for (unsigned i = 0; i < n_fn; ++i)
+			if (fn[i].estado == 2 && (f ? fn[i].flags & F_INDIRECTA : fn[i].marco < 0)) {
+				printf("%s%s", sep, __corto(fn[i].nombre));
+				sep = ", ";
+			}
+		if (sep[0] == ',')
+			printf("\n");
+	}
+
+	if (h) {
+		fprintf(h, "\n#endif // PILAS_H\n");
+		fclose(h);
+	}
+	return error;
+}
@@ -0,0 +1,196 @@
+/*
+ * Traza del scheduler (traza.h) a JSON de Chrome (Trace Event Format),
+ * para abrirla en ui.perfetto.dev o chrome://tracing.
+ *
+ * Uso: traza2json [fichero] > traza.json	(sin fichero: stdin)
+ *
+ * Acepta la salida de traza_volcar() y la de traza_drenar(). Cada tarea
+ * es un hilo con una franja por cada vez que tuvo la CPU (de TRAZA_ENTRA
+ * a TRAZA_SALE, con el motivo de la salida); el hilo 0 recibe los ticks
+ * y las notificaciones desde ISR, con una flecha hasta la siguiente
+ * entrada de la tarea notificada. Los eventos de cola y de notificación
+ * se marcan en la tarea en marcha.
+ */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "traza.h"
+
+static char nombre[256][16];
+static int primero = 1;		// Sin coma antes del próximo evento
+
+static uint32_t __get32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+	       (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void __evento(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+static void __evento(const char *fmt, ...)
+{
+	va_list ap;
+
+	fputs(primero ? "\n" : ",\n", stdout);
+	primero = 0;
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+}
+
+/* Instantáneo en el hilo 'tid' */
+static void __instante(double us, unsigned tid, const char *que, const char *args)
+{
+	__evento("{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+		 "\"name\":\"%s\",\"args\":{%s}}", tid, us, que, args);
+}
+
+int main(int argc, char **argv)
+{
+	FILE *f = stdin;
+	uint8_t c[16];
+
+	if (argc > 2) {
+		fprintf(stderr, "uso: %s [fichero]\n", argv[0]);
+		return 2;
+	}
+	if (argc == 2 && (f = fopen(argv[1], "rb")) == NULL) {
+		perror(argv[1]);
+		return 1;
+	}
+
+	if (fread(c, 1, 16, f) != 16 || memcmp(c, "TRZ", 3) != 0 ||
+	    c[3] != TRAZA_VERSION) {
+		fprintf(stderr, "no es una traza (versión %d)\n", TRAZA_VERSION);
+		return 1;
+	}
+	const double hz = (double)__get32(&c[4]);
+	const unsigned tareas = c[8];
+	const uint32_t perdidos_antes = __get32(&c[12]);
+
+	for (unsigned i = 0; i < tareas; ++i) {
+		uint8_t t[16];
+		if (fread(t, 1, 16, f) != 16) {
+			fprintf(stderr, "cabecera incompleta\n");
+			return 1;
+		}
+		/* Nombres de FreeRTOS: sin comillas ni barras que escapar */
+		for (unsigned j = 1; j < 16 && t[j]; ++j)
+			nombre[t[0]][j - 1] = t[j] == '"' || t[j] == '\\' ? '_' : (char)t[j];
+	}
+
+	printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	__evento("{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\","
+		 "\"args\":{\"name\":\"FreeRTOS\"}}");
+	__evento("{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"thread_name\","
+		 "\"args\":{\"name\":\"ISR/tick\"}}");
+	for (unsigned i = 1; i < 256; ++i)
+		if (nombre[i][0])
+			__evento("{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":"
+				 "\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+				 i, nombre[i]);
+
+	struct traza_reg r;
+	uint64_t t = 0;			// Ciclos desde el primero, sin vueltas
+	uint32_t anterior = 0;
+	unsigned long registros = 0;
+	int actual = -1;		// Tarea en marcha, -1 = desconocida
+	double inicio = 0.0;		// Su entrada, en us
+	unsigned flecha[256] = { 0 };	// Notificación pendiente por tarea
+	unsigned flechas = 0;
+	double us = 0.0;
+	char args[48];
+
+	while (fread(&r, sizeof(r), 1, f) == 1) {
+		if (registros++ == 0)
+			anterior = r.t;
+		t += (uint32_t)(r.t - anterior);
+		anterior = r.t;
+		us = (double)t * 1e6 / hz;
+
+		const unsigned ev = r.info & 0xFF;
+		const unsigned tarea = (r.info >> 8) & 0xFF;
+		const unsigned dato = r.info >> 16;
+		const unsigned tid = tarea ? tarea : actual > 0 ? (unsigned)actual : 0;
+
+		if (registros == 1 && perdidos_antes) {
+			snprintf(args, sizeof(args), "\"registros\":%lu",
+				 (unsigned long)perdidos_antes);
+			__instante(us, 0, "perdidos", args);
+		}
+
+		switch (ev) {
+		case TRAZA_ENTRA:
+			actual = (int)tarea;
+			inicio = us;
+			if (flecha[tarea]) {
+				__evento("{\"ph\":\"f\",\"bp\":\"e\",\"pid\":1,\"tid\":%u,"
+					 "\"ts\":%.3f,\"cat\":\"notif\",\"name\":"
+					 "\"notificación\",\"id\":%u}", tarea, us,
+					 flecha[tarea]);
+				flecha[tarea] = 0;
+			}
+			break;
+		case TRAZA_SALE:
+			if (actual == (int)tarea)
+				__evento("{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+					 "\"dur\":%.3f,\"name\":\"%s\",\"args\":"
+					 "{\"salida\":\"%s\"}}", tarea, inicio,
+					 us - inicio, nombre[tarea][0] ? nombre[tarea] : "?",
+					 dato ? "expulsada" : "bloqueada");
+			actual = -1;
+			break;
+		case TRAZA_TICK:
+			snprintf(args, sizeof(args), "\"tick\":%u", dato);
+			__instante(us, 0, "tick", args);
+			break;
+		case TRAZA_COLA_ENVIO:
+		case TRAZA_COLA_RECEPCION:
+		case TRAZA_COLA_BLOQUEO:
+			snprintf(args, sizeof(args), "\"cola\":\"0x%04x\"", dato);
+			__instante(us, tid, ev == TRAZA_COLA_ENVIO ? "cola: envío" :
+				   ev == TRAZA_COLA_RECEPCION ? "cola: recepción" :
+				   "cola: bloqueo", args);
+			break;
+		case TRAZA_NOTIF_ISR:
+			snprintf(args, sizeof(args), "\"tarea\":\"%s\"",
+				 nombre[dato & 0xFF]);
+			__instante(us, 0, "notificación ISR", args);
+			flecha[dato & 0xFF] = ++flechas;
+			__evento("{\"ph\":\"s\",\"pid\":1,\"tid\":0,\"ts\":%.3f,"
+				 "\"cat\":\"notif\",\"name\":\"notificación\","
+				 "\"id\":%u}", us, flechas);
+			break;
+		case TRAZA_NOTIF_BLOQUEO:
+			__instante(us, tid, "notificación: bloqueo", "");
+			break;
+		case TRAZA_NOTIF_TOMA:
+			__instante(us, tid, "notificación: tomada", "");
+			break;
+		case TRAZA_ESPERA:
+			__instante(us, tid, "espera", "");
+			break;
+		case TRAZA_PERDIDOS:
+			/* La franja en curso quedó cortada */
+			snprintf(args, sizeof(args), "\"registros\":%u", dato);
+			__instante(us, 0, "perdidos", args);
+			actual = -1;
+			break;
+		default:
+			break;
+		}
+	}
+
+	/* Franja abierta al final de la traza */
+	if (actual > 0)
+		__evento("{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,"
+			 "\"dur\":%.3f,\"name\":\"%s\"}", actual, inicio,
+			 us - inicio, nombre[actual][0] ? nombre[actual] : "?");
+
+	printf("\n]}\n");
+	fprintf(stderr, "%lu registros, %.3f ms\n", registros, us / 1000.0);
+	return 0;
+}
@@ -1,13 +1,14 @@
 #include "FreeRTOS.h"
 #include "task.h"
-#include "semphr.h"     // <-- AÑADIDO (para el Mutex)
 
 /* Nuestros módulos de configuración y tareas */
 #include "config.h"
 #include "app_tasks.h"
-
-/* Definición del Mutex global (usado en tasks.c) */
-SemaphoreHandle_t xAdcMutex;
+#include "banco_colas.h"
+#include "banco_mutex.h"
+#include "monitor.h"
+#include "rtstats.h"
+#include "traza.h"
 
 extern void vApplicationStackOverflowHook(xTaskHandle pxTask,signed portCHAR *pcTaskName);
 
@@ -30,37 +31,66 @@ main(void) {
 	adc_dma_init(); // Configura ADC1 y DMA1 para lectura continua
 	pwm_setup();    // <-- AÑADE ESTA LÍNEA (Configura TIM1 PWM en PA8)
 
-	/* --- 2. Creación de primitivas de FreeRTOS --- */
+	/* --- 2. Creación de Tareas de FreeRTOS --- */
+	/* (Los valores del ADC se publican sin Mutex, ver seqlatch.h) */
 	
-	/* ... (tu código de xSemaphoreCreateMutex) ... */
+	/* (Con MEMORIA_ESTATICA, pila y TCB estáticos: ver TAREA_CREAR) */
 
-	/* --- 3. Creación de Tareas de FreeRTOS --- */
-	
 	/* Tarea del LED (prioridad baja) */
-	xTaskCreate(vTaskLed,
+	TAREA_CREAR(vTaskLed,
 		    "LED",
-		    100,
-		    NULL,
+		    PILA_LED,
 		    configMAX_PRIORITIES - 3, // Prioridad 2 (Bajó 1)
 		    NULL);
 
 	/* Tarea de lectura del ADC (prioridad alta) */
-	xTaskCreate(vTaskReadAnalog,
+	TAREA_CREAR(vTaskReadAnalog,
 		    "ADC",
-		    128,
-		    NULL,
+		    PILA_ADC,
 		    configMAX_PRIORITIES - 1, // Prioridad 4 (más alta)
-		    NULL);
+		    &xTaskAdcHandle);
 
 	/* Tarea de Control PWM (prioridad media-alta) */
-	xTaskCreate(vTaskControlPWM,      // <-- AÑADE ESTE BLOQUE
+	TAREA_CREAR(vTaskControlPWM,
 		    "PWM_Ctrl",
-		    128,
-		    NULL,
+		    PILA_PWM,
 		    configMAX_PRIORITIES - 2, // Prioridad 3 (Menos que ADC, más que LED)
+		    &xTaskPwmCtrlHandle);
+
+#if MONITOR
+	/* Monitor de pilas y heap (prioridad 1, ver monitor.h) */
+	TAREA_CREAR(vTaskMonitor,
+		    "Monitor",
+		    PILA_MONITOR,
+		    PRIORIDAD_MONITOR,
+		    NULL);
+#endif
+
+#if BANCO_COLAS
+	/* Coste de las colas, una vez al arrancar (ver banco_colas.h) */
+	TAREA_CREAR(vTaskBancoColas,
+		    "BancoColas",
+		    PILA_BANCO_COLAS,
+		    PRIORIDAD_BANCO_COLAS,
+		    NULL);
+#endif
+
+#if BANCO_MUTEX
+	/* Coste de mutex_rapido frente al del kernel (ver banco_mutex.h) */
+	TAREA_CREAR(vTaskBancoMutex,
+		    "BancoMutex",
+		    PILA_BANCO_MUTEX,
+		    PRIORIDAD_BANCO_MUTEX,
 		    NULL);
+#endif
 
-	/* --- 4. Iniciar el Sistema --- */
+	/* --- 3. Iniciar el Sistema --- */
+#if RTSTATS
+	rtstats_init();	// Ciclos por tarea desde aquí (ver rtstats.h)
+#endif
+#if TRAZA
+	traza_init();	// Eventos del scheduler desde aquí (ver traza.h)
+#endif
 	vTaskStartScheduler();
 
 	/* Nunca debería llegar aquí */
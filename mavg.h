@@ -0,0 +1,51 @@
+#ifndef MAVG_H
+#define MAVG_H
+
+#include <stdint.h>
+
+/*
+ * Media móvil de muestras de 12 bits con suma acumulada.
+ *
+ * Cada muestra nueva resta la más antigua de la suma y la reemplaza en
+ * el anillo, así que tanto mavg_push() como mavg_value() son O(1) para
+ * cualquier tamaño de ventana. La ventana es 2^log2n muestras, fijada al
+ * compilar, de modo que la división del promedio es un desplazamiento.
+ *
+ *	MAVG_DEFINE(filtro, 8);		// 256 muestras
+ *	mavg_push(&filtro, raw);
+ *	uint16_t avg = mavg_value(&filtro);
+ *
+ * Las muestras son de 12 bits: la suma cabe en 32 bits hasta 2^20.
+ */
+#define MAVG_MAX_LOG2	20
+
+struct mavg {
+	uint32_t sum;
+	uint32_t idx;
+	uint32_t mask;		// 2^log2n - 1
+	uint8_t log2n;
+	uint16_t *buf;
+};
+
+#define MAVG_DEFINE(name, log2)						\
+	_Static_assert((log2) <= MAVG_MAX_LOG2, "ventana de " #name " demasiado grande"); \
+	static uint16_t name##_buf[1UL << (log2)];			\
+	static struct mavg name = {					\
+		.mask  = (1UL << (log2)) - 1,				\
+		.log2n = (log2),					\
+		.buf   = name##_buf,					\
+	}
+
+static inline void mavg_push(struct mavg *f, uint16_t sample)
+{
+	f->sum += (uint32_t)sample - f->buf[f->idx];
+	f->buf[f->idx] = sample;
+	f->idx = (f->idx + 1) & f->mask;
+}
+
+static inline uint16_t mavg_value(const struct mavg *f)
+{
+	return (uint16_t)(f->sum >> f->log2n);
+}
+
+#endif // MAVG_H
@@ -0,0 +1,122 @@
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "monitor.h"
+#include "seqlatch.h"
+
+#if MONITOR
+
+struct monitor_estado monitor;
+
+/* Último registro (ver seqlatch.h). Escritor: vTaskMonitor */
+static struct seqlatch latch;
+static struct monitor_registro publicado[2];
+
+/* tskSTACK_FILL_BYTE en cada byte de un StackType_t */
+#define RELLENO		((StackType_t)0xA5A5A5A5A5A5A5A5ULL)
+
+/*
+ * Mira hasta MONITOR_TRAMO palabras desde el cursor. La zona sin tocar
+ * sólo encoge, así que basta con mirar dentro de ella.
+ * @return 1 si se acabó la vuelta a esta tarea.
+ */
+static int __tramo(struct monitor_pila *p)
+{
+	const StackType_t *base = p->base;
+	uint32_t fin = p->cursor + MONITOR_TRAMO;
+
+	if (fin > p->libre)
+		fin = p->libre;
+	for (uint32_t i = p->cursor; i < fin; ++i)
+		if (base[i] != RELLENO) {
+			p->libre = i;
+			p->cursor = 0;
+			return 1;
+		}
+	if (fin == p->libre) {
+		p->cursor = 0;
+		return 1;
+	}
+	p->cursor = fin;
+	return 0;
+}
+
+static void __publicar(void)
+{
+	struct monitor_registro r = {
+		.vueltas = monitor.vueltas,
+		.version = MONITOR_VERSION,
+	};
+
+#if configSUPPORT_DYNAMIC_ALLOCATION
+	r.heap_min = xPortGetMinimumEverFreeHeapSize();
+	r.heap_libre = xPortGetFreeHeapSize();
+#endif
+	for (unsigned i = 0; i <= MONITOR_MAX_TAREAS; ++i) {
+		const struct monitor_pila *p = &monitor.pila[i];
+		if (p->tarea == NULL)
+			continue;
+		r.pila[i].tarea = (uint8_t)i;
+		r.pila[i].ini = p->libre != UINT32_MAX;
+		r.pila[i].libre = p->libre >= MONITOR_DESCONOCIDO ?
+				  MONITOR_DESCONOCIDO : (uint16_t)p->libre;
+		r.tareas = (uint8_t)(i + 1);
+	}
+
+	seqlatch_write_begin(&latch);
+	publicado[0] = r;
+	seqlatch_write_next(&latch);
+	publicado[1] = r;
+}
+
+/* Al siguiente hueco con tarea; al dar la vuelta, una vuelta más */
+static void __siguiente(void)
+{
+	for (unsigned i = 0; i <= MONITOR_MAX_TAREAS; ++i) {
+		if (++monitor.actual > MONITOR_MAX_TAREAS) {
+			monitor.actual = 0;
+			monitor.vueltas++;
+		}
+		if (monitor.pila[monitor.actual].tarea != NULL)
+			return;
+	}
+}
+
+void monitor_paso(void)
+{
+	struct monitor_pila *p = &monitor.pila[monitor.actual];
+
+	if (p->tarea != NULL && p->base == NULL) {
+		TaskStatus_t st;
+		vTaskGetInfo(p->tarea, &st, pdFALSE, eReady);
+		p->base = st.pxStackBase;
+		p->libre = UINT32_MAX;	// Hasta la primera palabra usada
+	}
+	if (p->tarea == NULL || __tramo(p))
+		__siguiente();
+
+	__publicar();
+}
+
+void monitor_leer(struct monitor_registro *r)
+{
+	uint32_t s;
+
+	do {
+		s = seqlatch_read_begin(&latch);
+		*r = publicado[seqlatch_index(s)];
+	} while (seqlatch_read_retry(&latch, s));
+}
+
+void vTaskMonitor(void *args)
+{
+	(void)args;
+	TickType_t t = xTaskGetTickCount();
+
+	for (;;) {
+		vTaskDelayUntil(&t, pdMS_TO_TICKS(MONITOR_PERIODO_MS));
+		monitor_paso();
+	}
+}
+
+#endif // MONITOR
@@ -0,0 +1,109 @@
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include <stdint.h>
+
+/*
+ * Monitor de pilas y heap en marcha (MONITOR = 1).
+ *
+ * Una tarea de prioridad baja (vTaskMonitor) mide el mínimo de pila
+ * libre de cada tarea (lo que nunca se ha escrito desde su creación:
+ * palabras con el relleno 0xA5 del kernel, contadas desde la base) y el
+ * mínimo de heap libre de heap_4.c, y lo publica en un registro de
+ * telemetría (monitor_leer()). Complementa a "make pilas": da el peor
+ * caso real tras semanas en marcha.
+ *
+ * Coste acotado: cada paso (cada MONITOR_PERIODO_MS) mira como mucho
+ * MONITOR_TRAMO palabras de la pila de una tarea, y sólo de la zona que
+ * seguía sin tocar. Una vuelta a todas las tareas lleva unos
+ * libre / MONITOR_TRAMO pasos por tarea; en el target, con 5 tareas de
+ * 100-128 palabras, unos 3 s. uxTaskGetStackHighWaterMark() recorre
+ * toda la zona libre de una vez.
+ *
+ * En el host las tareas corren en pilas propias del puerto (ucontext):
+ * la pila de FreeRTOS sólo guarda el contexto, así que sale casi entera
+ * libre; el heap sí es el de heap_4.c.
+ */
+
+#ifndef MONITOR_MAX_TAREAS
+#define MONITOR_MAX_TAREAS	8
+#endif
+
+#ifndef MONITOR_PERIODO_MS
+#define MONITOR_PERIODO_MS	100
+#endif
+
+/* Palabras de pila que se miran en cada paso */
+#ifndef MONITOR_TRAMO
+#define MONITOR_TRAMO		16
+#endif
+
+/* Pila y prioridad de vTaskMonitor (justo por encima de IDLE) */
+#define PILA_MONITOR		96
+#define PRIORIDAD_MONITOR	(tskIDLE_PRIORITY + 1)
+
+/* Sin medir aún (primera vuelta) */
+#define MONITOR_DESCONOCIDO	0xFFFFU
+
+/*
+ * Registro de telemetría, 12 + 4 * (MONITOR_MAX_TAREAS + 1) bytes sin
+ * relleno (little-endian en el target: se puede mandar tal cual).
+ */
+struct monitor_registro {
+	uint32_t heap_min;		// Bytes libres, mínimo histórico
+	uint32_t heap_libre;		// Bytes libres ahora
+	uint16_t vueltas;		// Vueltas completas a todas las tareas
+	uint8_t tareas;			// Huecos usados en pila[]
+	uint8_t version;		// MONITOR_VERSION
+	struct {
+		uint8_t tarea;		// uxTCBNumber (0 = hueco libre)
+		uint8_t ini;		// 1 = ya medida (si no, libre no vale)
+		uint16_t libre;		// Palabras (StackType_t) libres, mínimo
+	} pila[MONITOR_MAX_TAREAS + 1];
+};
+
+#define MONITOR_VERSION		1
+
+struct monitor_pila {
+	void *tarea;			// TaskHandle_t
+	const void *base;		// pxStackBase (al primer paso)
+	uint32_t libre;			// StackType_t sin tocar desde la base
+	uint32_t cursor;		// Siguiente palabra en esta vuelta
+};
+
+struct monitor_estado {
+	struct monitor_pila pila[MONITOR_MAX_TAREAS + 1];
+	unsigned actual;		// Hueco que se está mirando
+	uint16_t vueltas;
+};
+
+extern struct monitor_estado monitor;
+
+/* traceTASK_CREATE: recuerda el handle de cada tarea, aún sin medir */
+static inline void monitor_creada(void *tarea, unsigned n)
+{
+	if (n <= MONITOR_MAX_TAREAS)
+		monitor.pila[n] = (struct monitor_pila){
+			.tarea = tarea,
+			.libre = UINT32_MAX,
+		};
+}
+
+/**
+ * @brief Un paso del monitor: un tramo de pila y el heap, y publica.
+ *
+ * Lo llama vTaskMonitor; desde una sola tarea.
+ */
+void monitor_paso(void);
+
+/**
+ * @brief Copia el último registro publicado (tareas e ISRs).
+ */
+void monitor_leer(struct monitor_registro *r);
+
+/**
+ * @brief Tarea del monitor: monitor_paso() cada MONITOR_PERIODO_MS.
+ */
+void vTaskMonitor(void *args);
+
+#endif // MONITOR_H
@@ -0,0 +1,143 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "list.h"
+
+#include "mutex_rapido.h"
+
+void mutex_rapido_init_techo(struct mutex_rapido *m, UBaseType_t techo)
+{
+	configASSERT(techo < configMAX_PRIORITIES);
+	m->estado = 0;
+	vListInitialise(&m->espera);
+	m->techo = techo;
+	m->previa = 0;
+	m->nivel = 0;
+}
+
+/* Deshace lo que hizo tomar antes de intentarlo, si no lo ha conseguido */
+static void __deshacer(struct mutex_rapido *m, UBaseType_t previa,
+		       UBaseType_t nivel)
+{
+	if (m->techo == MUTEX_RAPIDO_HERENCIA) {
+		vTaskDecrementMutexHeldCount();
+		return;
+	}
+	taskENTER_CRITICAL();
+	if (xTaskPriorityLowerFromCeiling(m->techo, previa, nivel) != pdFALSE)
+		portYIELD_WITHIN_API();
+	taskEXIT_CRITICAL();
+}
+
+/*
+ * Sube al techo y, si está libre, lo toma, todo en la misma sección
+ * crítica: desde ahí ninguna otra tarea que lo use puede adelantarse.
+ */
+BaseType_t mutex_rapido_tomar_techo(struct mutex_rapido *m, TickType_t espera)
+{
+	UBaseType_t previa, nivel;
+
+	taskENTER_CRITICAL();
+	uintptr_t yo = (uintptr_t)pvTaskPriorityRaiseToCeiling(m->techo, &previa,
+							       &nivel);
+
+	if (m->estado == 0) {
+		m->estado = yo;
+		m->previa = previa;
+		m->nivel = nivel;
+		taskEXIT_CRITICAL();
+		return pdTRUE;
+	}
+	taskEXIT_CRITICAL();
+	return mutex_rapido_tomar_lento(m, yo, previa, nivel, espera);
+}
+
+/*
+ * Ocupado: con interrupciones enmascaradas nadie más toca 'estado' (el
+ * dueño interrumpido entre LDREX y STREX ve fallar su STREX), así que
+ * aquí basta con leer y escribir.
+ */
+BaseType_t mutex_rapido_tomar_lento(struct mutex_rapido *m, uintptr_t yo,
+				    UBaseType_t previa, UBaseType_t nivel,
+				    TickType_t espera)
+{
+	TimeOut_t t;
+	BaseType_t bloqueada = pdFALSE;
+
+	for (;;) {
+		taskENTER_CRITICAL();
+		uintptr_t e = m->estado;
+		uintptr_t dueno = e & ~MUTEX_RAPIDO_ESPERAS;
+
+		/* No recursivo: el dueño que lo vuelve a tomar se bloquearía */
+		configASSERT(bloqueada || dueno != yo);
+
+		if (e == 0)
+			m->estado = yo;
+		if (e == 0 || dueno == yo) {
+			/* Libre, o entregado por mutex_rapido_dar_lento() */
+			m->previa = previa;
+			m->nivel = nivel;
+			taskEXIT_CRITICAL();
+			return pdTRUE;
+		}
+
+		if (espera == 0) {
+			taskEXIT_CRITICAL();
+			break;
+		}
+		if (!bloqueada) {
+			vTaskSetTimeOutState(&t);
+			bloqueada = pdTRUE;
+		} else if (xTaskCheckForTimeOut(&t, &espera) != pdFALSE) {
+			taskEXIT_CRITICAL();
+			break;
+		}
+
+		/* El dueño ya no lo puede dar sin pasar por aquí abajo */
+		m->estado = e | MUTEX_RAPIDO_ESPERAS;
+		if (m->techo == MUTEX_RAPIDO_HERENCIA)	// Con techo ya está arriba
+			vTaskPriorityInherit((TaskHandle_t)dueno);
+		vTaskPlaceOnEventList(&m->espera, espera);
+		portYIELD_WITHIN_API();
+		taskEXIT_CRITICAL();
+	}
+
+	__deshacer(m, previa, nivel);
+	return pdFALSE;
+}
+
+/*
+ * Hay (o hubo) tareas en espera, o hay techo: el mutex pasa a la primera
+ * de la lista sin quedar libre, para que otra tarea no se lo quite antes
+ * de que ésa llegue a ejecutarse. Si no hay ninguna, queda libre.
+ */
+void mutex_rapido_dar_lento(struct mutex_rapido *m)
+{
+	BaseType_t cambiar = pdFALSE;
+
+	taskENTER_CRITICAL();
+	uintptr_t yo = m->estado & ~MUTEX_RAPIDO_ESPERAS;
+
+	if (listLIST_IS_EMPTY(&m->espera)) {
+		m->estado = 0;
+	} else {
+		uintptr_t siguiente =
+			(uintptr_t)listGET_OWNER_OF_HEAD_ENTRY(&m->espera);
+
+		cambiar = xTaskRemoveFromEventList(&m->espera);
+		m->estado = siguiente |
+			(listLIST_IS_EMPTY(&m->espera) ? 0 : MUTEX_RAPIDO_ESPERAS);
+	}
+
+	if (m->techo != MUTEX_RAPIDO_HERENCIA) {
+		if (xTaskPriorityLowerFromCeiling(m->techo, m->previa,
+						  m->nivel) != pdFALSE)
+			cambiar = pdTRUE;
+	} else if (xTaskPriorityDisinherit((TaskHandle_t)yo) != pdFALSE) {
+		/* Comprueba también que quien lo da es el dueño */
+		cambiar = pdTRUE;
+	}
+	if (cambiar)
+		portYIELD_WITHIN_API();
+	taskEXIT_CRITICAL();
+}
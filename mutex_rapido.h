@@ -0,0 +1,170 @@
+#ifndef MUTEX_RAPIDO_H
+#define MUTEX_RAPIDO_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "list.h"
+
+/*
+ * Mutex entre tareas que, si está libre, se toma y se da con un único
+ * compare-and-swap (LDREX/STREX en el Cortex-M3) sin sección crítica ni
+ * llamada a queue.c. Sólo si hay disputa se pasa al kernel: la tarea que
+ * espera hereda su prioridad al dueño y se bloquea en una lista de eventos
+ * propia, y al dar el mutex se entrega directamente a la primera de la
+ * lista (la de más prioridad).
+ *
+ *	static struct mutex_rapido m;
+ *	mutex_rapido_init(&m);			// una vez, antes de usarlo
+ *	if (mutex_rapido_tomar(&m, portMAX_DELAY)) {
+ *		...
+ *		mutex_rapido_dar(&m);
+ *	}
+ *
+ * 'estado' es el TCB del dueño (0 = libre) con MUTEX_RAPIDO_ESPERAS en el
+ * bit 0 mientras haya tareas bloqueadas: con ese bit el CAS de dar falla
+ * y el dueño pasa por el camino lento. Cuenta en uxMutexesHeld como los
+ * mutex del kernel, así que la herencia se deshace al dar el último mutex
+ * que se tenga, sea de este tipo o del kernel.
+ *
+ * Con techo (mutex_rapido_init_techo(), protocolo de techo inmediato)
+ * quien lo toma pasa en el acto a la prioridad 'techo', que debe ser la
+ * más alta de las tareas que lo usan: ninguna de ellas puede adelantarse
+ * al dueño, así que no hay disputa ni herencia que llevar, y lo más que
+ * espera una tarea es la sección más larga de las de menos prioridad que
+ * usan un mutex con techo igual o superior a ella. A cambio, tomar y dar
+ * pasan siempre por una sección crítica corta para cambiar de prioridad.
+ * Si aun así hay disputa (otra tarea con la prioridad del techo, por
+ * reparto de tiempo), se espera como sin techo pero sin herencia: el
+ * dueño ya está en el techo. Tomarlo desde una tarea con prioridad base
+ * mayor que el techo es un error (configASSERT).
+ *
+ * Un mutex con techo se da en el orden inverso al que se tomó: todos los
+ * mutex tomados después, de cualquier tipo, deben estar ya dados. Si no,
+ * la prioridad de antes que se restaura ya no vale (configASSERT).
+ *
+ * Se elige por mutex en compilación con el techo: MUTEX_RAPIDO_HERENCIA
+ * (0) es la herencia de prioridad de arriba, p. ej.
+ *
+ *	#ifndef TECHO_MUESTRAS
+ *	#define TECHO_MUESTRAS	(configMAX_PRIORITIES - 1)
+ *	#endif
+ *	mutex_rapido_init_techo(&muestras, TECHO_MUESTRAS);
+ *
+ * Sólo tareas, con el scheduler en marcha; no recursivo. Ver
+ * banco_mutex.h para el coste frente a xSemaphoreTake()/xSemaphoreGive().
+ */
+
+#define MUTEX_RAPIDO_ESPERAS	((uintptr_t)1)
+#define MUTEX_RAPIDO_HERENCIA	0	// Sin techo
+
+struct mutex_rapido {
+	volatile uintptr_t estado;	// TCB del dueño | MUTEX_RAPIDO_ESPERAS
+	List_t espera;			// Tareas bloqueadas, por prioridad
+	UBaseType_t techo;		// Prioridad techo, o MUTEX_RAPIDO_HERENCIA
+	UBaseType_t previa;		// Prioridad del dueño al tomarlo (techo)
+	UBaseType_t nivel;		// Mutex que tenía el dueño, con éste
+};
+
+/*
+ * *p = nuevo si *p == viejo; 1 si lo ha cambiado. Una interrupción entre
+ * LDREX y STREX borra el monitor exclusivo y hace fallar el STREX: el
+ * llamante vuelve a intentarlo. Núcleo único: sin DMB, basta con que el
+ * compilador no mueva accesos a memoria a través del CAS.
+ *
+ * En el host sólo hay un hilo y las tareas sólo cambian dentro de las
+ * llamadas al kernel (ver rtos/port_host.c): leer, comparar y escribir
+ * ya es atómico, y cuesta como LDREX/STREX y no como un lock cmpxchg.
+ */
+static inline int mutex_rapido_cas(volatile uintptr_t *p, uintptr_t viejo,
+				   uintptr_t nuevo)
+{
+#ifdef HOST_PORT
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	if (*p != viejo)
+		return 0;
+	*p = nuevo;
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	return 1;
+#else
+	uintptr_t actual;
+	uint32_t fallo;
+
+	__asm__ volatile("ldrex %0, [%1]" : "=r"(actual) : "r"(p) : "memory");
+	if (actual != viejo) {
+		__asm__ volatile("clrex" ::: "memory");
+		return 0;
+	}
+	__asm__ volatile("strex %0, %2, [%1]"
+			 : "=&r"(fallo) : "r"(p), "r"(nuevo) : "memory");
+	return fallo == 0;
+#endif
+}
+
+/**
+ * @brief Deja el mutex libre y sin tareas en espera.
+ * @param techo Prioridad techo (menor que configMAX_PRIORITIES), o
+ * MUTEX_RAPIDO_HERENCIA para herencia de prioridad.
+ */
+void mutex_rapido_init_techo(struct mutex_rapido *m, UBaseType_t techo);
+
+/**
+ * @brief Como mutex_rapido_init_techo(), con herencia de prioridad.
+ */
+static inline void mutex_rapido_init(struct mutex_rapido *m)
+{
+	mutex_rapido_init_techo(m, MUTEX_RAPIDO_HERENCIA);
+}
+
+/* Caminos lentos y con techo (mutex_rapido.c) */
+BaseType_t mutex_rapido_tomar_lento(struct mutex_rapido *m, uintptr_t yo,
+				    UBaseType_t previa, UBaseType_t nivel,
+				    TickType_t espera);
+BaseType_t mutex_rapido_tomar_techo(struct mutex_rapido *m, TickType_t espera);
+void mutex_rapido_dar_lento(struct mutex_rapido *m);
+
+/**
+ * @brief Toma el mutex, esperando como mucho 'espera' ticks.
+ * @return pdTRUE si se ha tomado, pdFALSE si se agotó la espera.
+ */
+static inline BaseType_t mutex_rapido_tomar(struct mutex_rapido *m,
+					    TickType_t espera)
+{
+	if (m->techo != MUTEX_RAPIDO_HERENCIA)
+		return mutex_rapido_tomar_techo(m, espera);
+
+	/* Cuenta como mutex tomado ya; el camino lento la deshace si falla */
+	uintptr_t yo = (uintptr_t)pvTaskIncrementMutexHeldCount();
+
+	do {
+		if (mutex_rapido_cas(&m->estado, 0, yo))
+			return pdTRUE;
+	} while (m->estado == 0);	// STREX interrumpido
+	return mutex_rapido_tomar_lento(m, yo, 0, 0, espera);
+}
+
+/**
+ * @brief Da el mutex (sólo su dueño).
+ */
+static inline void mutex_rapido_dar(struct mutex_rapido *m)
+{
+	uintptr_t e;
+
+	if (m->techo != MUTEX_RAPIDO_HERENCIA) {
+		mutex_rapido_dar_lento(m);
+		return;
+	}
+
+	/* El dueño es quien llama: no hace falta preguntar al kernel */
+	while (((e = m->estado) & MUTEX_RAPIDO_ESPERAS) == 0) {
+		configASSERT(e != 0);
+		if (mutex_rapido_cas(&m->estado, e, 0)) {
+			vTaskDecrementMutexHeldCount();
+			return;
+		}
+	}
+	mutex_rapido_dar_lento(m);
+}
+
+#endif // MUTEX_RAPIDO_H
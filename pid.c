@@ -0,0 +1,80 @@
+#include "pid.h"
+
+/*
+ * Notación: todos los términos (P, I, D) y la salida se llevan en Q16.16
+ * en unidades de salida. Con errores y medidas de 12 bits y ganancias de
+ * hasta ~±32767 en Q16.16, los productos caben en 64 bits y el resultado
+ * se satura a 32 bits antes de guardarlo.
+ */
+
+static inline int32_t __sat32(int64_t x, int32_t lo, int32_t hi)
+{
+	if (x < lo) return lo;
+	if (x > hi) return hi;
+	return (int32_t)x;
+}
+
+void pid_init(struct pid *pid, const struct pid_gains *gains,
+	      int32_t out_min, int32_t out_max)
+{
+	pid->g = *gains;
+	pid->out_min = out_min * 65536;
+	pid->out_max = out_max * 65536;
+	pid->integ = 0;
+	pid->dfilt = 0;
+	pid->prev_meas = 0;
+	pid->prev_err = 0;
+}
+
+void pid_reset(struct pid *pid, int32_t meas, int32_t out)
+{
+	/* Con error cero y derivada nula sólo queda el término integral */
+	pid->integ = __sat32((int64_t)out * 65536, pid->out_min, pid->out_max);
+	pid->dfilt = 0;
+	pid->prev_meas = meas;
+	pid->prev_err = 0;
+}
+
+void pid_set_gains(struct pid *pid, const struct pid_gains *gains)
+{
+	/*
+	 * Con el último error y la última derivada, la salida pasaría de
+	 * kp*e - kd*d a kp'*e - kd'*d. El integrador compensa la diferencia,
+	 * así que el siguiente paso parte del mismo valor. Cambiar ki no
+	 * provoca salto porque el integrador ya guarda ki * Σe.
+	 */
+	int64_t bump = (int64_t)(pid->g.kp - gains->kp) * pid->prev_err
+		     - (((int64_t)(pid->g.kd - gains->kd) * pid->dfilt) >> 16);
+
+	pid->integ = __sat32(pid->integ + bump, pid->out_min, pid->out_max);
+	pid->g = *gains;
+}
+
+int32_t pid_step(struct pid *pid, int32_t setpoint, int32_t meas)
+{
+	int32_t err = setpoint - meas;
+
+	/* Derivada sobre la medida, filtrada: d += (Δmedida - d) >> d_shift */
+	int32_t dmeas = (meas - pid->prev_meas) * 65536;
+	pid->dfilt += (dmeas - pid->dfilt) >> pid->g.d_shift;
+	pid->prev_meas = meas;
+
+	int64_t p = (int64_t)pid->g.kp * err;
+	int64_t d = ((int64_t)pid->g.kd * pid->dfilt) >> 16;
+	int32_t u_raw = __sat32(p + pid->integ - d, INT32_MIN, INT32_MAX);
+	int32_t u = __sat32(u_raw, pid->out_min, pid->out_max);
+
+	/*
+	 * Integrador con back-calculation: mientras la salida está saturada,
+	 * kaw * (u - u_raw) descarga lo que el término integral añade de más.
+	 * El límite al rango de salida acota el caso de kaw = 0.
+	 */
+	int64_t integ = (int64_t)pid->integ
+		      + (int64_t)pid->g.ki * err
+		      + (((int64_t)pid->g.kaw * ((int64_t)u - u_raw)) >> 16);
+	pid->integ = __sat32(integ, pid->out_min, pid->out_max);
+	pid->prev_err = err;
+
+	/* Redondeo al entero más próximo */
+	return (int32_t)(((int64_t)u + 0x8000) >> 16);
+}
@@ -0,0 +1,73 @@
+#ifndef PID_H
+#define PID_H
+
+#include <stdint.h>
+
+/*
+ * Controlador PID discreto en punto fijo (sólo enteros, sin divisiones).
+ *
+ * - Ganancias en Q16.16, "por muestra": el período de muestreo va
+ *   incluido en ki y kd (ki = Ki * T, kd = Kd / T).
+ * - Derivada sobre la medida (sin salto al cambiar el setpoint) y
+ *   filtrada con un paso bajo de primer orden: d += (Δmedida - d) >> d_shift.
+ * - Anti-windup por back-calculation: el integrador se corrige con
+ *   kaw * (salida saturada - salida sin saturar), y además se limita al
+ *   rango de la salida.
+ * - Cambio de ganancias sin saltos (bumpless): la diferencia que el
+ *   cambio provocaría en los términos P y D se absorbe en el integrador.
+ *
+ * Medida, setpoint y salida son enteros en las unidades de la aplicación
+ * (aquí códigos de 12 bits). Un paso cuesta 3 multiplicaciones 32x32->64
+ * (SMULL en el Cortex-M3), sumas y desplazamientos.
+ */
+
+/* Convierte una constante a Q16.16 al compilar (no usar en tiempo de ejecución). */
+#define PID_Q16(x)	((int32_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+struct pid_gains {
+	int32_t kp;		// Q16.16
+	int32_t ki;		// Q16.16, por muestra
+	int32_t kd;		// Q16.16, por muestra
+	int32_t kaw;		// Q16.16, ganancia de back-calculation
+	uint8_t d_shift;	// Filtro de la derivada: 0 = sin filtro
+};
+
+struct pid {
+	struct pid_gains g;
+	int32_t out_min;	// Q16.16
+	int32_t out_max;	// Q16.16
+
+	/* Estado */
+	int32_t integ;		// Término integral, Q16.16 en unidades de salida
+	int32_t dfilt;		// Δmedida filtrada, Q16.16
+	int32_t prev_meas;
+	int32_t prev_err;
+};
+
+/**
+ * @brief Inicializa el controlador con salida limitada a [out_min, out_max].
+ *
+ * Parte de integrador y derivada a cero; usar pid_reset() para arrancar
+ * sin saltos desde una salida conocida.
+ */
+void pid_init(struct pid *pid, const struct pid_gains *gains,
+	      int32_t out_min, int32_t out_max);
+
+/**
+ * @brief Reinicia el estado para que el próximo paso, con medida 'meas' y
+ *        error cero, devuelva 'out' (transferencia sin saltos).
+ */
+void pid_reset(struct pid *pid, int32_t meas, int32_t out);
+
+/**
+ * @brief Cambia las ganancias sin provocar un salto en la salida.
+ */
+void pid_set_gains(struct pid *pid, const struct pid_gains *gains);
+
+/**
+ * @brief Un paso del controlador.
+ * @return Salida (saturada a [out_min, out_max], redondeada).
+ */
+int32_t pid_step(struct pid *pid, int32_t setpoint, int32_t meas);
+
+#endif // PID_H
@@ -0,0 +1,70 @@
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "pool.h"
+
+void pool_init(struct pool *p)
+{
+	p->libre = NULL;
+	for (unsigned i = p->n; i-- > 0;) {
+		void **b = (void **)(p->mem + (size_t)i * p->tam);
+		*b = p->libre;
+		p->libre = b;
+	}
+	p->usados = p->max_usados = 0;
+}
+
+static inline void *__tomar(struct pool *p)
+{
+	void **b = p->libre;
+
+	if (b != NULL) {
+		p->libre = *b;
+		if (++p->usados > p->max_usados)
+			p->max_usados = p->usados;
+	}
+	return b;
+}
+
+static inline void __soltar(struct pool *p, void *bloque)
+{
+	configASSERT((uint8_t *)bloque >= p->mem &&
+		     (uint8_t *)bloque < p->mem + (size_t)p->n * p->tam);
+	*(void **)bloque = p->libre;
+	p->libre = bloque;
+	p->usados--;
+}
+
+void *pool_tomar(struct pool *p)
+{
+	void *b;
+
+	taskENTER_CRITICAL();
+	b = __tomar(p);
+	taskEXIT_CRITICAL();
+	return b;
+}
+
+void pool_soltar(struct pool *p, void *bloque)
+{
+	taskENTER_CRITICAL();
+	__soltar(p, bloque);
+	taskEXIT_CRITICAL();
+}
+
+void *pool_tomar_isr(struct pool *p)
+{
+	UBaseType_t m = taskENTER_CRITICAL_FROM_ISR();
+	void *b = __tomar(p);
+
+	taskEXIT_CRITICAL_FROM_ISR(m);
+	return b;
+}
+
+void pool_soltar_isr(struct pool *p, void *bloque)
+{
+	UBaseType_t m = taskENTER_CRITICAL_FROM_ISR();
+
+	__soltar(p, bloque);
+	taskEXIT_CRITICAL_FROM_ISR(m);
+}
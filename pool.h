@@ -0,0 +1,65 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Reserva de bloques de tamaño fijo en O(1), para elementos de colas y
+ * mensajes: los bloques libres forman una lista enlazada a través de
+ * ellos mismos, así que tomar y soltar son dos accesos a memoria dentro
+ * de una sección crítica. Sin fragmentación ni cabeceras: un bloque de
+ * 24 bytes ocupa 24 bytes (heap_4 añade 8 y redondea a 8).
+ *
+ *	POOL_DEFINE(mensajes, sizeof(struct mensaje), 16);
+ *	struct mensaje *m = pool_tomar(&mensajes);	// NULL si no quedan
+ *	...
+ *	pool_soltar(&mensajes, m);
+ *
+ * Desde ISRs, pool_tomar_isr() / pool_soltar_isr(). Ver
+ * bench/bench_heap.c para la comparación con heap_1..heap_5.
+ */
+
+struct pool {
+	void *libre;			// Primer bloque libre, o NULL
+	uint8_t *mem;
+	size_t tam;			// Bytes por bloque (múltiplo de un puntero)
+	unsigned n;			// Bloques
+	unsigned usados, max_usados;
+};
+
+/* Tamaño de bloque: al menos un puntero, y alineado para él */
+#define POOL_TAM(tam) \
+	(((tam) + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *))
+
+#define POOL_DEFINE(name, tam, nbloques)				\
+	static void *name##_mem[POOL_TAM(tam) / sizeof(void *) * (nbloques)]; \
+	static struct pool name = {					\
+		.mem = (uint8_t *)name##_mem,				\
+		.tam = POOL_TAM(tam),					\
+		.n   = (nbloques),					\
+	}
+
+/**
+ * @brief Encadena todos los bloques (antes del primer pool_tomar()).
+ *
+ * También sirve para un struct pool rellenado a mano con 'mem' de
+ * n * POOL_TAM(tam) bytes alineados a puntero.
+ */
+void pool_init(struct pool *p);
+
+/**
+ * @brief Toma un bloque (tareas).
+ * @return El bloque, o NULL si no queda ninguno.
+ */
+void *pool_tomar(struct pool *p);
+
+/**
+ * @brief Devuelve un bloque tomado de este pool (tareas).
+ */
+void pool_soltar(struct pool *p, void *bloque);
+
+void *pool_tomar_isr(struct pool *p);
+void pool_soltar_isr(struct pool *p, void *bloque);
+
+#endif // POOL_H
@@ -0,0 +1,40 @@
+#include "pwm_dither.h"
+
+uint32_t pwm_dither_fill(volatile uint16_t *buf, unsigned log2n,
+			 uint32_t period, uint32_t duty_q16)
+{
+	const uint32_t n = 1U << log2n;
+	const unsigned shift = 16 - log2n;
+
+	if (duty_q16 > PWM_DUTY_Q16_ONE)
+		duty_q16 = PWM_DUTY_Q16_ONE;
+
+	/* CCR exacto en Q16 (UMULL): parte entera y fracción en 1/N */
+	uint64_t ccr_q16 = (uint64_t)period * duty_q16;
+	uint32_t base = (uint32_t)(ccr_q16 >> 16);
+	uint32_t frac = (((uint32_t)ccr_q16 & 0xFFFFU) + ((1U << shift) >> 1)) >> shift;
+
+	if (frac == n) {	// El redondeo llega al siguiente entero
+		base++;
+		frac = 0;
+	}
+
+	/* CCR de 16 bits: con ARR = 65535 el 100% queda en 65535/65536 */
+	uint32_t hi = base + 1;
+	if (hi > 0xFFFFU) hi = 0xFFFFU;
+	if (base > 0xFFFFU) base = 0xFFFFU;
+
+	/* Sigma-delta: frac de cada N períodos llevan base + 1 */
+	uint32_t acc = 0;
+	for (uint32_t i = 0; i < n; ++i) {
+		acc += frac;
+		if (acc >= n) {
+			acc -= n;
+			buf[i] = (uint16_t)hi;
+		} else {
+			buf[i] = (uint16_t)base;
+		}
+	}
+
+	return 2 * frac >= n ? hi : base;
+}
@@ -0,0 +1,36 @@
+#ifndef PWM_DITHER_H
+#define PWM_DITHER_H
+
+#include <stdint.h>
+
+/*
+ * PWM de alta resolución por dithering (modulador sigma-delta de primer
+ * orden sobre el CCR).
+ *
+ * Con un período de P cuentas el CCR sólo da P niveles de duty. Si el
+ * CCR se cambia en cada período siguiendo un patrón de N = 2^n valores,
+ * unos CCR = base y otros CCR = base + 1, la media sobre los N períodos
+ * tiene P * N niveles: n bits efectivos más. El patrón lo recorre el DMA
+ * en cada evento de actualización (ver hal_pwm_set_duty()), así que la
+ * CPU sólo interviene cuando cambia el duty.
+ *
+ * El modulador reparte los "+1" de forma uniforme en el patrón, de modo
+ * que el rizado que añade está a la frecuencia más alta posible
+ * (f_pwm / N como mucho) y lo filtra mejor el paso bajo de la salida.
+ */
+
+/* Duty en Q16: 0 = 0%, PWM_DUTY_Q16_ONE = 100% */
+#define PWM_DUTY_Q16_ONE	65536U
+
+/**
+ * @brief Rellena un patrón de 2^log2n valores de CCR para el duty pedido.
+ * @param buf      Destino (p. ej. el búfer circular del DMA).
+ * @param log2n    Bits de dithering (1..16).
+ * @param period   Cuentas por período (ARR + 1).
+ * @param duty_q16 Duty en Q16 (0..PWM_DUTY_Q16_ONE).
+ * @return CCR base del patrón (el que se usaría sin dithering, redondeado).
+ */
+uint32_t pwm_dither_fill(volatile uint16_t *buf, unsigned log2n,
+			 uint32_t period, uint32_t duty_q16);
+
+#endif // PWM_DITHER_H
@@ -0,0 +1,315 @@
+/*
+    FreeRTOS V9.0.0 - Host (Linux) simulation port.
+
+    Runs the unmodified tasks.c, queue.c and list.c kernel inside a normal
+    Linux process so that the application tasks can be executed, profiled
+    (perf, valgrind) and measured without a target.
+
+    Model
+    -----
+    - Every task is a ucontext(3) coroutine with its own host stack.  Only
+      one host thread ever runs, so the kernel needs no host locking.
+    - Critical sections and "interrupt masking" are counters.  A yield
+      requested while they are held is left pending and taken when they are
+      released, which is how PendSV behaves on the Cortex-M3.
+    - The tick is virtual.  vPortHostTick() is the equivalent of the
+      SysTick handler and is called from the idle task, so simulated time
+      only advances when every application task is blocked.  Task code
+      therefore takes zero simulated time, and an hour of simulated control
+      loop runs in a few seconds.  vPortHostSetTickPacing() can slow the
+      tick down to (a multiple of) real time when that is wanted instead.
+
+    1 tab == 4 spaces!
+*/
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the host port.
+ *----------------------------------------------------------*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ucontext.h>
+
+#if defined( __has_include )
+	#if __has_include( <valgrind/valgrind.h> )
+		#include <valgrind/valgrind.h>
+		#define portHOST_HAVE_VALGRIND 1
+	#endif
+#endif
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Size of the host stack given to each task.  The FreeRTOS stack passed to
+pxPortInitialiseStack() is sized in target words and is far too small for
+host code (libc, printf, ...), so it only holds a pointer to the context. */
+#ifndef portHOST_STACK_SIZE
+	#define portHOST_STACK_SIZE		( 64 * 1024 )
+#endif
+
+/* Host side state of a task. */
+typedef struct HostTaskContext
+{
+	ucontext_t xContext;
+	void *pvStack;
+	TaskFunction_t pxCode;
+	void *pvParameters;
+} HostTaskContext_t;
+
+/* The currently running TCB, owned by tasks.c.  Its first member is
+pxTopOfStack, which for this port points at the HostTaskContext_t pointer. */
+extern void * volatile pxCurrentTCB;
+
+/* Each task maintains its own interrupt status in the critical nesting
+variable on the target; the same scheme is used here.  The initial value is
+non-zero so that critical sections used before the scheduler starts do not
+unmask anything. */
+static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
+
+/* Simulated interrupt mask (BASEPRI on the target). */
+static UBaseType_t uxInterruptsMasked = pdTRUE;
+
+/* Equivalent of the PendSV pending bit. */
+static BaseType_t xPortYieldPending = pdFALSE;
+
+/* Context of the thread that called vTaskStartScheduler(), resumed by
+vPortEndScheduler(). */
+static ucontext_t xSchedulerContext;
+
+/* Virtual tick pacing. */
+static uint32_t ulNanosecondsPerTick = 0;
+static uint64_t ullTicksElapsed = 0;
+static struct timespec xPacingEpoch;
+
+/*
+ * Context switch proper: select the next task and swap to it.
+ */
+static void prvSwitchContext( void );
+
+/*
+ * Entry point of every task coroutine.
+ */
+static void prvTaskEntry( void );
+
+/*-----------------------------------------------------------*/
+
+static HostTaskContext_t *prvContextOf( void *pxTCB )
+{
+StackType_t *pxTopOfStack = *( StackType_t ** ) pxTCB;
+
+	return ( HostTaskContext_t * ) *pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+HostTaskContext_t *pxContext;
+
+	pxContext = malloc( sizeof( HostTaskContext_t ) );
+	configASSERT( pxContext );
+	pxContext->pvStack = malloc( portHOST_STACK_SIZE );
+	configASSERT( pxContext->pvStack );
+	pxContext->pxCode = pxCode;
+	pxContext->pvParameters = pvParameters;
+
+	getcontext( &( pxContext->xContext ) );
+	pxContext->xContext.uc_stack.ss_sp = pxContext->pvStack;
+	pxContext->xContext.uc_stack.ss_size = portHOST_STACK_SIZE;
+	pxContext->xContext.uc_link = NULL;
+	makecontext( &( pxContext->xContext ), prvTaskEntry, 0 );
+
+	#ifdef portHOST_HAVE_VALGRIND
+	{
+		( void ) VALGRIND_STACK_REGISTER( pxContext->pvStack, ( char * ) pxContext->pvStack + portHOST_STACK_SIZE );
+	}
+	#endif
+
+	/* The only thing kept on the FreeRTOS stack is the context pointer. */
+	*pxTopOfStack = ( StackType_t ) pxContext;
+
+	return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskEntry( void )
+{
+HostTaskContext_t *pxContext = prvContextOf( pxCurrentTCB );
+
+	pxContext->pxCode( pxContext->pvParameters );
+
+	/* A task function must not return - it should delete itself instead. */
+	vPortHostAssert( __FILE__, __LINE__ );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+	/* Initialise the critical nesting count ready for the first task, and
+	unmask "interrupts" as the first task starts running. */
+	uxCriticalNesting = 0;
+	uxInterruptsMasked = pdFALSE;
+	xPortYieldPending = pdFALSE;
+
+	ullTicksElapsed = 0;
+	clock_gettime( CLOCK_MONOTONIC, &xPacingEpoch );
+
+	/* Start the first task.  Control only comes back here through
+	vPortEndScheduler(). */
+	swapcontext( &xSchedulerContext, &( prvContextOf( pxCurrentTCB )->xContext ) );
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+	uxInterruptsMasked = pdTRUE;
+	swapcontext( &( prvContextOf( pxCurrentTCB )->xContext ), &xSchedulerContext );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchContext( void )
+{
+void *pxPreviousTCB = pxCurrentTCB;
+
+	xPortYieldPending = pdFALSE;
+
+	/* vTaskSwitchContext() runs with interrupts masked, as it does from
+	xPortPendSVHandler on the target. */
+	uxInterruptsMasked = pdTRUE;
+	vTaskSwitchContext();
+	uxInterruptsMasked = pdFALSE;
+
+	if( pxCurrentTCB != pxPreviousTCB )
+	{
+		swapcontext( &( prvContextOf( pxPreviousTCB )->xContext ), &( prvContextOf( pxCurrentTCB )->xContext ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunPendingYield( void )
+{
+	if( ( xPortYieldPending != pdFALSE ) && ( uxInterruptsMasked == pdFALSE ) && ( uxCriticalNesting == 0 ) )
+	{
+		prvSwitchContext();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	xPortYieldPending = pdTRUE;
+	prvRunPendingYield();
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	portDISABLE_INTERRUPTS();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		portENABLE_INTERRUPTS();
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortSetInterruptMask( void )
+{
+UBaseType_t uxSavedMask = uxInterruptsMasked;
+
+	uxInterruptsMasked = pdTRUE;
+	return uxSavedMask;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxSavedMask )
+{
+	uxInterruptsMasked = uxSavedMask;
+	prvRunPendingYield();
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	uxInterruptsMasked = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	uxInterruptsMasked = pdFALSE;
+	prvRunPendingYield();
+}
+/*-----------------------------------------------------------*/
+
+static void prvPaceTick( void )
+{
+struct timespec xDeadline;
+uint64_t ullNanoseconds;
+
+	ullNanoseconds = ( uint64_t ) xPacingEpoch.tv_nsec + ( ullTicksElapsed * ulNanosecondsPerTick );
+	xDeadline.tv_sec = xPacingEpoch.tv_sec + ( time_t ) ( ullNanoseconds / 1000000000ULL );
+	xDeadline.tv_nsec = ( long ) ( ullNanoseconds % 1000000000ULL );
+
+	while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &xDeadline, NULL ) != 0 )
+	{
+		/* Interrupted by a signal, sleep again. */
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortHostTick( void )
+{
+UBaseType_t uxSavedMask;
+
+	ullTicksElapsed++;
+	if( ulNanosecondsPerTick != 0 )
+	{
+		prvPaceTick();
+	}
+
+	/* Same sequence as xPortSysTickHandler(): increment the tick with
+	interrupts masked and pend a context switch if one is required. */
+	uxSavedMask = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		if( xTaskIncrementTick() != pdFALSE )
+		{
+			xPortYieldPending = pdTRUE;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedMask );
+}
+/*-----------------------------------------------------------*/
+
+void vPortHostSetTickPacing( uint32_t ulNanoseconds )
+{
+	ulNanosecondsPerTick = ulNanoseconds;
+	ullTicksElapsed = 0;
+	clock_gettime( CLOCK_MONOTONIC, &xPacingEpoch );
+}
+/*-----------------------------------------------------------*/
+
+void vPortHostAssert( const char *pcFile, unsigned long ulLine )
+{
+	fprintf( stderr, "configASSERT failed: %s:%lu\n", pcFile, ulLine );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+/* The virtual tick source.  The idle task only runs when every other task is
+blocked, so this is where simulated time moves forward. */
+void vApplicationIdleHook( void )
+{
+	vPortHostTick();
+}
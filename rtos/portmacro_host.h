@@ -0,0 +1,142 @@
+/*
+    FreeRTOS V9.0.0 - Host (Linux) simulation port.
+
+    Port specific definitions for running the unmodified tasks.c, queue.c
+    and list.c kernel as a normal Linux process.  Tasks are ucontext(3)
+    coroutines driven by a single host thread, and the tick is virtual:
+    see port_host.c.
+
+    This header is selected from FreeRTOSConfig.h when HOST_PORT is
+    defined, in place of the Cortex-M3 portmacro.h.
+
+    1 tab == 4 spaces!
+*/
+
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*-----------------------------------------------------------
+ * Port specific definitions.
+ *
+ * The settings in this file configure FreeRTOS correctly for the
+ * host (x86-64 / AArch64 Linux, GCC or Clang).
+ *
+ * These settings should not be altered.
+ *-----------------------------------------------------------
+ */
+
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	uintptr_t
+#define portBASE_TYPE	long
+#define portPOINTER_SIZE_TYPE	uintptr_t
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef uint16_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffff
+#else
+	typedef uint32_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+
+	/* Only one host thread ever touches the kernel, so reads of the tick
+	count do not need to be guarded with a critical section. */
+	#define portTICK_TYPE_IS_ATOMIC 1
+#endif
+/*-----------------------------------------------------------*/
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_PERIOD_MS			( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+/*-----------------------------------------------------------*/
+
+/* Scheduler utilities.  As with PendSV on the target, a yield requested
+while interrupts are masked or inside a critical section is held pending
+and performed when the mask is lifted. */
+extern void vPortYield( void );
+#define portYIELD()									vPortYield()
+#define portEND_SWITCHING_ISR( xSwitchRequired )	if( xSwitchRequired != pdFALSE ) portYIELD()
+#define portYIELD_FROM_ISR( x )						portEND_SWITCHING_ISR( x )
+/*-----------------------------------------------------------*/
+
+/* Critical section management.  There is no asynchronous interrupt source
+on the host, so "masking interrupts" only defers yields and simulated
+ISRs. */
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+extern UBaseType_t uxPortSetInterruptMask( void );
+extern void vPortClearInterruptMask( UBaseType_t uxSavedMask );
+extern void vPortDisableInterrupts( void );
+extern void vPortEnableInterrupts( void );
+#define portSET_INTERRUPT_MASK_FROM_ISR()		uxPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	vPortClearInterruptMask(x)
+#define portDISABLE_INTERRUPTS()				vPortDisableInterrupts()
+#define portENABLE_INTERRUPTS()					vPortEnableInterrupts()
+#define portENTER_CRITICAL()					vPortEnterCritical()
+#define portEXIT_CRITICAL()						vPortExitCritical()
+
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+/*-----------------------------------------------------------*/
+
+/* Generic (portable C) task selection is used on the host. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#endif
+
+/*-----------------------------------------------------------*/
+
+#define portNOP()
+
+#define portINLINE	__inline
+
+#ifndef portFORCE_INLINE
+	#define portFORCE_INLINE inline __attribute__(( always_inline))
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* Host specific API (port_host.c). */
+
+/*
+ * Advance simulated time by one tick, exactly as the SysTick handler does
+ * on the target.  Called by the port from the idle task; may also be called
+ * by a host harness that wants to drive time itself.
+ */
+void vPortHostTick( void );
+
+/*
+ * Throttle the virtual tick so that each tick takes at least
+ * ulNanosecondsPerTick of wall-clock time.  0 (the default) runs simulated
+ * time as fast as the host allows.
+ */
+void vPortHostSetTickPacing( uint32_t ulNanosecondsPerTick );
+
+/*
+ * Called by configASSERT() on the host.  Prints the location and aborts.
+ */
+void vPortHostAssert( const char *pcFile, unsigned long ulLine );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
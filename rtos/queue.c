@@ -114,6 +114,71 @@ zero. */
 #define queueSEMAPHORE_QUEUE_ITEM_LENGTH ( ( UBaseType_t ) 0 )
 #define queueMUTEX_GIVE_BLOCK_TIME		 ( ( TickType_t ) 0U )
 
+#if ( configUSE_QUEUE_LOANS == 1 )
+	/* In ring order the storage holds the borrowed items, the messages, the
+	reserved slots and then the free slots.  Each region must stay contiguous,
+	so an item can only be copied in or out where it does not land inside a
+	loan: not to the back behind a reservation that is still being filled,
+	not to the front over a borrowed item, and not out of the head while an
+	older item is still borrowed (its slot would free up out of order). */
+	#define queueFREE_SLOTS( pxQueue )	( ( pxQueue )->uxLength - ( pxQueue )->uxMessagesWaiting - ( pxQueue )->uxReserved - ( pxQueue )->uxBorrowed )
+	#define queueCAN_SEND( pxQueue, xCopyPosition )												\
+		( ( ( xCopyPosition ) == queueOVERWRITE ) ||												\
+			( ( queueFREE_SLOTS( pxQueue ) > ( UBaseType_t ) 0 ) &&								\
+			  ( ( ( xCopyPosition ) == queueSEND_TO_BACK ) ? ( pxQueue )->uxReserved == ( UBaseType_t ) 0 : ( pxQueue )->uxBorrowed == ( UBaseType_t ) 0 ) ) )
+	#define queueCAN_RECEIVE( pxQueue, xJustPeeking )	\
+		( ( ( pxQueue )->uxMessagesWaiting > ( UBaseType_t ) 0 ) && ( ( ( xJustPeeking ) != pdFALSE ) || ( ( pxQueue )->uxBorrowed == ( UBaseType_t ) 0 ) ) )
+
+	/* Overwriting cannot fail, so it cannot wait for a loan to be returned:
+	on a queue of length one the only slot is either lent or holds the item
+	to overwrite. */
+	#define queueASSERT_NO_LOAN_ON_OVERWRITE( pxQueue, xCopyPosition )	\
+		configASSERT( !( ( ( xCopyPosition ) == queueOVERWRITE ) && ( ( ( pxQueue )->uxReserved | ( pxQueue )->uxBorrowed ) != ( UBaseType_t ) 0 ) ) )
+#else
+	#define queueFREE_SLOTS( pxQueue )	( ( pxQueue )->uxLength - ( pxQueue )->uxMessagesWaiting )
+	#define queueCAN_SEND( pxQueue, xCopyPosition )		( ( ( pxQueue )->uxMessagesWaiting < ( pxQueue )->uxLength ) || ( ( xCopyPosition ) == queueOVERWRITE ) )
+	#define queueCAN_RECEIVE( pxQueue, xJustPeeking )	( ( pxQueue )->uxMessagesWaiting > ( UBaseType_t ) 0 )
+	#define queueASSERT_NO_LOAN_ON_OVERWRITE( pxQueue, xCopyPosition )
+#endif
+
+/*
+ * Copies one item between the queue storage area and a caller's buffer.
+ */
+portFORCE_INLINE static void prvCopyItem( void * const pvDest, const void * const pvSource, const UBaseType_t uxSize )
+{
+	#if ( configQUEUE_SMALL_ITEM_COPY == 1 )
+	{
+		/* Items of 2, 4 and 8 bytes - the usual mailbox payloads - are copied
+		with a memcpy() of constant size, which the compiler expands into one
+		or two loads and stores instead of a call into the C library.  The
+		item size is fixed when the queue is created, so the branch always
+		goes the same way for a given queue.  Neither the caller's buffer nor
+		the storage area need be aligned: the compiler cannot assume they are,
+		and on the Cortex-M3 it emits plain LDR/STR, which accept unaligned
+		addresses. */
+		switch( uxSize )
+		{
+			case 2U:
+				( void ) memcpy( pvDest, pvSource, ( size_t ) 2U );
+				break;
+			case 4U:
+				( void ) memcpy( pvDest, pvSource, ( size_t ) 4U );
+				break;
+			case 8U:
+				( void ) memcpy( pvDest, pvSource, ( size_t ) 8U );
+				break;
+			default:
+				( void ) memcpy( pvDest, pvSource, ( size_t ) uxSize );
+				break;
+		}
+	}
+	#else
+	{
+		( void ) memcpy( pvDest, pvSource, ( size_t ) uxSize );
+	}
+	#endif /* configQUEUE_SMALL_ITEM_COPY */
+}
+
 #if( configUSE_PREEMPTION == 0 )
 	/* If the cooperative scheduler is being used then a yield should not be
 	performed just because a higher priority task has been woken. */
@@ -149,6 +214,11 @@ typedef struct QueueDefinition
 	volatile int8_t cRxLock;		/*< Stores the number of items received from the queue (removed from the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 	volatile int8_t cTxLock;		/*< Stores the number of items transmitted to the queue (added to the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 
+	#if ( configUSE_QUEUE_LOANS == 1 )
+		UBaseType_t uxReserved;		/*< Slots handed out by pvQueueReserve() and not yet committed.  They follow pcWriteTo's last uxReserved steps. */
+		UBaseType_t uxBorrowed;		/*< Items handed out by pvQueueBorrow() and not yet released.  They are the last uxBorrowed slots read from. */
+	#endif
+
 	#if( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 		uint8_t ucStaticallyAllocated;	/*< Set to pdTRUE if the memory used by the queue was statically allocated to ensure no attempt is made to free the memory. */
 	#endif
@@ -208,18 +278,20 @@ typedef xQUEUE Queue_t;
 static void prvUnlockQueue( Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
 
 /*
- * Uses a critical section to determine if there is any data in a queue.
+ * Uses a critical section to determine if there is any data in a queue that
+ * can be received (or peeked, if xJustPeeking is pdTRUE).
  *
  * @return pdTRUE if the queue contains no items, otherwise pdFALSE.
  */
-static BaseType_t prvIsQueueEmpty( const Queue_t *pxQueue ) PRIVILEGED_FUNCTION;
+static BaseType_t prvIsQueueEmpty( const Queue_t *pxQueue, const BaseType_t xJustPeeking ) PRIVILEGED_FUNCTION;
 
 /*
- * Uses a critical section to determine if there is any space in a queue.
+ * Uses a critical section to determine if there is any space in a queue for
+ * an item copied to xCopyPosition.
  *
  * @return pdTRUE if there is no space, otherwise pdFALSE;
  */
-static BaseType_t prvIsQueueFull( const Queue_t *pxQueue ) PRIVILEGED_FUNCTION;
+static BaseType_t prvIsQueueFull( const Queue_t *pxQueue, const BaseType_t xCopyPosition ) PRIVILEGED_FUNCTION;
 
 /*
  * Copies an item into the queue, either at the front of the queue or the
@@ -232,6 +304,24 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue, const void *pvIte
  */
 static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * Copy uxItems consecutive items to the back of the queue, or out of its
+ * head, with at most two memcpy() calls (the storage area may wrap).  The
+ * caller has checked there is room, or enough items.
+ */
+static void prvCopyItemsToQueue( Queue_t * const pxQueue, const void *pvItems, const UBaseType_t uxItems ) PRIVILEGED_FUNCTION;
+static void prvCopyItemsFromQueue( Queue_t * const pxQueue, void * const pvBuffer, const UBaseType_t uxItems ) PRIVILEGED_FUNCTION;
+
+/*
+ * Unblock up to uxCount tasks from pxEventList after uxCount items were
+ * posted, or slots freed, in one go - one per item, as the same number of
+ * single item calls would - or, if the queue is locked, add them to its lock
+ * count (pcLock is the matching cTxLock or cRxLock).  Called with interrupts
+ * masked.  Returns pdTRUE if a task with a priority above the running task
+ * was unblocked.
+ */
+static BaseType_t prvWakeTasks( List_t * const pxEventList, volatile int8_t * const pcLock, UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
 #if ( configUSE_QUEUE_SETS == 1 )
 	/*
 	 * Checks to see if a queue is a member of a queue set, and if so, notifies
@@ -240,6 +330,23 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer
 	static BaseType_t prvNotifyQueueSetContainer( const Queue_t * const pxQueue, const BaseType_t xCopyPosition ) PRIVILEGED_FUNCTION;
 #endif
 
+#if ( configUSE_QUEUE_LOANS == 1 )
+	/*
+	 * Common parts of the loan API.  All are called with interrupts masked.
+	 * prvTakeLoan() hands out the next free slot (xReserve == pdTRUE) or the
+	 * head item, or returns NULL.  prvReturnLoan() commits a reserved slot or
+	 * releases a borrowed item, and unblocks the tasks that may now proceed;
+	 * it returns pdTRUE if one of them has a priority above the running task.
+	 */
+	static void *prvTakeLoan( Queue_t * const pxQueue, const BaseType_t xReserve ) PRIVILEGED_FUNCTION;
+	static BaseType_t prvReturnLoan( Queue_t * const pxQueue, const void * const pvItem, const BaseType_t xReserve ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Uses a critical section to determine if prvTakeLoan() would fail.
+	 */
+	static BaseType_t prvIsLoanUnavailable( const Queue_t *pxQueue, const BaseType_t xReserve ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * Called after a Queue_t structure has been allocated either statically or
  * dynamically to fill in the structure's members.
@@ -291,6 +398,13 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		pxQueue->cRxLock = queueUNLOCKED;
 		pxQueue->cTxLock = queueUNLOCKED;
 
+		#if ( configUSE_QUEUE_LOANS == 1 )
+		{
+			pxQueue->uxReserved = ( UBaseType_t ) 0U;
+			pxQueue->uxBorrowed = ( UBaseType_t ) 0U;
+		}
+		#endif
+
 		if( xNewQueue == pdFALSE )
 		{
 			/* If there are tasks blocked waiting to read from the queue, then
@@ -747,7 +861,8 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			highest priority task wanting to access the queue.  If the head item
 			in the queue is to be overwritten then it does not matter if the
 			queue is full. */
-			if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) )
+			queueASSERT_NO_LOAN_ON_OVERWRITE( pxQueue, xCopyPosition );
+			if( queueCAN_SEND( pxQueue, xCopyPosition ) )
 			{
 				traceQUEUE_SEND( pxQueue );
 				xYieldRequired = prvCopyDataToQueue( pxQueue, pvItemToQueue, xCopyPosition );
@@ -876,7 +991,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		/* Update the timeout state to see if it has expired yet. */
 		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
 		{
-			if( prvIsQueueFull( pxQueue ) != pdFALSE )
+			if( prvIsQueueFull( pxQueue, xCopyPosition ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_SEND( pxQueue );
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
@@ -951,7 +1066,8 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 	post). */
 	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
 	{
-		if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) )
+		queueASSERT_NO_LOAN_ON_OVERWRITE( pxQueue, xCopyPosition );
+		if( queueCAN_SEND( pxQueue, xCopyPosition ) )
 		{
 			const int8_t cTxLock = pxQueue->cTxLock;
 
@@ -1261,7 +1377,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
 			/* Is there data in the queue now?  To be running the calling task
 			must be the highest priority task wanting to access the queue. */
-			if( uxMessagesWaiting > ( UBaseType_t ) 0 )
+			if( queueCAN_RECEIVE( pxQueue, xJustPeeking ) )
 			{
 				/* Remember the read position in case the queue is only being
 				peeked. */
@@ -1373,7 +1489,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		/* Update the timeout state to see if it has expired yet. */
 		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
 		{
-			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			if( prvIsQueueEmpty( pxQueue, xJustPeeking ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
 
@@ -1417,7 +1533,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			prvUnlockQueue( pxQueue );
 			( void ) xTaskResumeAll();
 
-			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			if( prvIsQueueEmpty( pxQueue, xJustPeeking ) != pdFALSE )
 			{
 				traceQUEUE_RECEIVE_FAILED( pxQueue );
 				return errQUEUE_EMPTY;
@@ -1461,7 +1577,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
 		/* Cannot block in an ISR, so check there is data available. */
-		if( uxMessagesWaiting > ( UBaseType_t ) 0 )
+		if( queueCAN_RECEIVE( pxQueue, pdFALSE ) )
 		{
 			const int8_t cRxLock = pxQueue->cRxLock;
 
@@ -1576,120 +1692,910 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 }
 /*-----------------------------------------------------------*/
 
-UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue )
+BaseType_t xQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxItems, TickType_t xTicksToWait )
 {
-UBaseType_t uxReturn;
-
-	configASSERT( xQueue );
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+UBaseType_t uxSent;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
-	taskENTER_CRITICAL();
+	configASSERT( pxQueue );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U ); /* Semaphores give one at a time. */
+	configASSERT( !( ( pvItems == NULL ) && ( uxItems != ( UBaseType_t ) 0U ) ) );
+	#if ( configUSE_QUEUE_SETS == 1 )
 	{
-		uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+		/* A set holds one handle per item, posted one at a time. */
+		configASSERT( pxQueue->pxQueueSetContainer == NULL );
 	}
-	taskEXIT_CRITICAL();
-
-	return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
-/*-----------------------------------------------------------*/
+	#endif
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
 
-UBaseType_t uxQueueSpacesAvailable( const QueueHandle_t xQueue )
-{
-UBaseType_t uxReturn;
-Queue_t *pxQueue;
+	/* The same loop as xQueueGenericSend() to the back of the queue, except
+	that as many items as fit are copied in one critical section.  One
+	receiving task is unblocked per item, as many sends would. */
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( ( uxItems == ( UBaseType_t ) 0U ) || queueCAN_SEND( pxQueue, queueSEND_TO_BACK ) )
+			{
+				uxSent = queueFREE_SLOTS( pxQueue );
+				if( uxSent > uxItems )
+				{
+					uxSent = uxItems;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 
-	pxQueue = ( Queue_t * ) xQueue;
-	configASSERT( pxQueue );
+				/* Empty transfers are not traced. */
+				if( uxSent > ( UBaseType_t ) 0U )
+				{
+					traceQUEUE_SEND( pxQueue );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+				prvCopyItemsToQueue( pxQueue, pvItems, uxSent );
 
-	taskENTER_CRITICAL();
-	{
-		uxReturn = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
-	}
-	taskEXIT_CRITICAL();
+				if( prvWakeTasks( &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->cTxLock ), uxSent ) != pdFALSE )
+				{
+					queueYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 
-	return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
-/*-----------------------------------------------------------*/
+				taskEXIT_CRITICAL();
+				return ( BaseType_t ) uxSent;
+			}
+			else
+			{
+				if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					taskEXIT_CRITICAL();
+					traceQUEUE_SEND_FAILED( pxQueue );
+					return 0;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					vTaskSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					/* Entry time was already set. */
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
 
-UBaseType_t uxQueueMessagesWaitingFromISR( const QueueHandle_t xQueue )
-{
-UBaseType_t uxReturn;
+		vTaskSuspendAll();
+		prvLockQueue( pxQueue );
 
-	configASSERT( xQueue );
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			if( prvIsQueueFull( pxQueue, queueSEND_TO_BACK ) != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+				prvUnlockQueue( pxQueue );
 
-	uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+			}
+			else
+			{
+				/* Try again. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+			}
+		}
+		else
+		{
+			/* The timeout has expired. */
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
 
-	return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+			traceQUEUE_SEND_FAILED( pxQueue );
+			return 0;
+		}
+	}
+}
 /*-----------------------------------------------------------*/
 
-void vQueueDelete( QueueHandle_t xQueue )
+BaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxItems, BaseType_t * const pxHigherPriorityTaskWoken )
 {
+UBaseType_t uxSent = 0;
+UBaseType_t uxSavedInterruptStatus;
 Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
 	configASSERT( pxQueue );
-	traceQUEUE_DELETE( pxQueue );
-
-	#if ( configQUEUE_REGISTRY_SIZE > 0 )
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	configASSERT( !( ( pvItems == NULL ) && ( uxItems != ( UBaseType_t ) 0U ) ) );
+	#if ( configUSE_QUEUE_SETS == 1 )
 	{
-		vQueueUnregisterQueue( pxQueue );
+		configASSERT( pxQueue->pxQueueSetContainer == NULL );
 	}
 	#endif
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-	#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
-	{
-		/* The queue can only have been allocated dynamically - free it
-		again. */
-		vPortFree( pxQueue );
-	}
-	#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
 	{
-		/* The queue could have been allocated statically or dynamically, so
-		check before attempting to free the memory. */
-		if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+		if( queueCAN_SEND( pxQueue, queueSEND_TO_BACK ) )
 		{
-			vPortFree( pxQueue );
+			uxSent = queueFREE_SLOTS( pxQueue );
+			if( uxSent > uxItems )
+			{
+				uxSent = uxItems;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* Empty transfers are not traced. */
+			if( uxSent > ( UBaseType_t ) 0U )
+			{
+				traceQUEUE_SEND_FROM_ISR( pxQueue );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+			prvCopyItemsToQueue( pxQueue, pvItems, uxSent );
+
+			if( ( prvWakeTasks( &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->cTxLock ), uxSent ) != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+			{
+				*pxHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
 		}
 		else
 		{
-			mtCOVERAGE_TEST_MARKER();
+			traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
 		}
 	}
-	#else
-	{
-		/* The queue must have been statically allocated, so is not going to be
-		deleted.  Avoid compiler warnings about the unused parameter. */
-		( void ) pxQueue;
-	}
-	#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return ( BaseType_t ) uxSent;
 }
 /*-----------------------------------------------------------*/
 
-#if ( configUSE_TRACE_FACILITY == 1 )
+BaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxItems, TickType_t xTicksToWait )
+{
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+UBaseType_t uxReceived;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
-	UBaseType_t uxQueueGetQueueNumber( QueueHandle_t xQueue )
+	configASSERT( pxQueue );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U ); /* Semaphores are taken one at a time. */
+	configASSERT( !( ( pvBuffer == NULL ) && ( uxItems != ( UBaseType_t ) 0U ) ) );
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
 	{
-		return ( ( Queue_t * ) xQueue )->uxQueueNumber;
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
 	}
+	#endif
 
-#endif /* configUSE_TRACE_FACILITY */
-/*-----------------------------------------------------------*/
-
-#if ( configUSE_TRACE_FACILITY == 1 )
-
-	void vQueueSetQueueNumber( QueueHandle_t xQueue, UBaseType_t uxQueueNumber )
+	/* The same loop as xQueueGenericReceive(), taking as many items as are
+	there (up to uxItems) in one critical section.  One sending task is
+	unblocked per freed slot, as many receives would. */
+	for( ;; )
 	{
-		( ( Queue_t * ) xQueue )->uxQueueNumber = uxQueueNumber;
-	}
-
-#endif /* configUSE_TRACE_FACILITY */
-/*-----------------------------------------------------------*/
+		taskENTER_CRITICAL();
+		{
+			if( ( uxItems == ( UBaseType_t ) 0U ) || queueCAN_RECEIVE( pxQueue, pdFALSE ) )
+			{
+				uxReceived = pxQueue->uxMessagesWaiting;
+				if( uxReceived > uxItems )
+				{
+					uxReceived = uxItems;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 
-#if ( configUSE_TRACE_FACILITY == 1 )
+				/* Empty transfers are not traced. */
+				if( uxReceived > ( UBaseType_t ) 0U )
+				{
+					traceQUEUE_RECEIVE( pxQueue );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+				prvCopyItemsFromQueue( pxQueue, pvBuffer, uxReceived );
 
-	uint8_t ucQueueGetQueueType( QueueHandle_t xQueue )
-	{
-		return ( ( Queue_t * ) xQueue )->ucQueueType;
-	}
+				if( prvWakeTasks( &( pxQueue->xTasksWaitingToSend ), &( pxQueue->cRxLock ), uxReceived ) != pdFALSE )
+				{
+					queueYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				taskEXIT_CRITICAL();
+				return ( BaseType_t ) uxReceived;
+			}
+			else
+			{
+				if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					taskEXIT_CRITICAL();
+					traceQUEUE_RECEIVE_FAILED( pxQueue );
+					return 0;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					vTaskSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					/* Entry time was already set. */
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		vTaskSuspendAll();
+		prvLockQueue( pxQueue );
+
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			if( prvIsQueueEmpty( pxQueue, pdFALSE ) != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+				prvUnlockQueue( pxQueue );
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				/* Try again. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+			}
+		}
+		else
+		{
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
+
+			if( prvIsQueueEmpty( pxQueue, pdFALSE ) != pdFALSE )
+			{
+				traceQUEUE_RECEIVE_FAILED( pxQueue );
+				return 0;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxItems, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+UBaseType_t uxReceived = 0;
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	configASSERT( !( ( pvBuffer == NULL ) && ( uxItems != ( UBaseType_t ) 0U ) ) );
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		if( queueCAN_RECEIVE( pxQueue, pdFALSE ) )
+		{
+			uxReceived = pxQueue->uxMessagesWaiting;
+			if( uxReceived > uxItems )
+			{
+				uxReceived = uxItems;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* Empty transfers are not traced. */
+			if( uxReceived > ( UBaseType_t ) 0U )
+			{
+				traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+			prvCopyItemsFromQueue( pxQueue, pvBuffer, uxReceived );
+
+			if( ( prvWakeTasks( &( pxQueue->xTasksWaitingToSend ), &( pxQueue->cRxLock ), uxReceived ) != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+			{
+				*pxHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return ( BaseType_t ) uxReceived;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_LOANS == 1 )
+
+	void *pvQueueGenericLoan( QueueHandle_t xQueue, TickType_t xTicksToWait, const BaseType_t xReserve )
+	{
+	BaseType_t xEntryTimeSet = pdFALSE;
+	TimeOut_t xTimeOut;
+	void *pvItem;
+	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U ); /* Nothing to lend from a semaphore. */
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+		{
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
+
+		/* The same loop as xQueueGenericSend() (reserving) and
+		xQueueGenericReceive() (borrowing), with the copy replaced by handing
+		out a pointer to the slot.  A reservation waits for space in the same
+		event list as the senders, a borrow for data in the same list as the
+		receivers, so the highest priority waiting task is still the one
+		unblocked whatever API it used. */
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				pvItem = prvTakeLoan( pxQueue, xReserve );
+
+				if( pvItem != NULL )
+				{
+					if( xReserve == pdFALSE )
+					{
+						traceQUEUE_RECEIVE( pxQueue );
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+
+					/* Neither handing out a free slot nor borrowing an item
+					makes room or data for anybody else, so there is nothing
+					to unblock until the loan is returned. */
+					taskEXIT_CRITICAL();
+					return pvItem;
+				}
+				else if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					taskEXIT_CRITICAL();
+
+					if( xReserve != pdFALSE )
+					{
+						traceQUEUE_SEND_FAILED( pxQueue );
+					}
+					else
+					{
+						traceQUEUE_RECEIVE_FAILED( pxQueue );
+					}
+					return NULL;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					vTaskSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					/* Entry time was already set. */
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			vTaskSuspendAll();
+			prvLockQueue( pxQueue );
+
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+			{
+				if( prvIsLoanUnavailable( pxQueue, xReserve ) != pdFALSE )
+				{
+					if( xReserve != pdFALSE )
+					{
+						traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+						vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+					}
+					else
+					{
+						traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+						vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+					}
+
+					prvUnlockQueue( pxQueue );
+					if( xTaskResumeAll() == pdFALSE )
+					{
+						portYIELD_WITHIN_API();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					/* Try again. */
+					prvUnlockQueue( pxQueue );
+					( void ) xTaskResumeAll();
+				}
+			}
+			else
+			{
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+
+				/* As in xQueueGenericReceive(), take a slot that became
+				available just as the time ran out rather than failing. */
+				if( prvIsLoanUnavailable( pxQueue, xReserve ) != pdFALSE )
+				{
+					if( xReserve != pdFALSE )
+					{
+						traceQUEUE_SEND_FAILED( pxQueue );
+					}
+					else
+					{
+						traceQUEUE_RECEIVE_FAILED( pxQueue );
+					}
+					return NULL;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vQueueGenericEndLoan( QueueHandle_t xQueue, const void * const pvItem, const BaseType_t xReserve )
+	{
+	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+		configASSERT( pxQueue );
+
+		taskENTER_CRITICAL();
+		{
+			if( xReserve != pdFALSE )
+			{
+				traceQUEUE_SEND( pxQueue );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( prvReturnLoan( pxQueue, pvItem, xReserve ) != pdFALSE )
+			{
+				/* Yes it is ok to do this from within the critical section -
+				the kernel takes care of that. */
+				queueYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	void *pvQueueGenericLoanFromISR( QueueHandle_t xQueue, const BaseType_t xReserve )
+	{
+	void *pvItem;
+	UBaseType_t uxSavedInterruptStatus;
+	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			pvItem = prvTakeLoan( pxQueue, xReserve );
+
+			if( pvItem != NULL )
+			{
+				if( xReserve == pdFALSE )
+				{
+					traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else if( xReserve != pdFALSE )
+			{
+				traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
+			}
+			else
+			{
+				traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return pvItem;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vQueueGenericEndLoanFromISR( QueueHandle_t xQueue, const void * const pvItem, const BaseType_t xReserve, BaseType_t * const pxHigherPriorityTaskWoken )
+	{
+	UBaseType_t uxSavedInterruptStatus;
+	Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+		configASSERT( pxQueue );
+		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( xReserve != pdFALSE )
+			{
+				traceQUEUE_SEND_FROM_ISR( pxQueue );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( ( prvReturnLoan( pxQueue, pvItem, xReserve ) != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+			{
+				*pxHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void *prvTakeLoan( Queue_t * const pxQueue, const BaseType_t xReserve )
+	{
+	int8_t *pcItem = NULL;
+
+		if( xReserve != pdFALSE )
+		{
+			if( queueFREE_SLOTS( pxQueue ) > ( UBaseType_t ) 0 )
+			{
+				/* Hand out the slot a copy to the back would have used. */
+				pcItem = pxQueue->pcWriteTo;
+				pxQueue->pcWriteTo += pxQueue->uxItemSize;
+				if( pxQueue->pcWriteTo >= pxQueue->pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+				{
+					pxQueue->pcWriteTo = pxQueue->pcHead;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+				( pxQueue->uxReserved )++;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+			{
+				/* As prvCopyDataFromQueue(), but the item stays where it is
+				and its slot is not free until released. */
+				pxQueue->u.pcReadFrom += pxQueue->uxItemSize;
+				if( pxQueue->u.pcReadFrom >= pxQueue->pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+				{
+					pxQueue->u.pcReadFrom = pxQueue->pcHead;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+				pcItem = pxQueue->u.pcReadFrom;
+				( pxQueue->uxMessagesWaiting )--;
+				( pxQueue->uxBorrowed )++;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		return ( void * ) pcItem;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvReturnLoan( Queue_t * const pxQueue, const void * const pvItem, const BaseType_t xReserve )
+	{
+	BaseType_t xReturn = pdFALSE;
+	const size_t xStorage = ( size_t ) ( pxQueue->pcTail - pxQueue->pcHead );
+	size_t xOffset, xBack;
+
+		/* Loans are returned in the order they were taken, so the slot
+		returned must be the oldest one lent: uxReserved items back from
+		pcWriteTo, or uxBorrowed - 1 items back from pcReadFrom. */
+		if( xReserve != pdFALSE )
+		{
+			configASSERT( pxQueue->uxReserved > ( UBaseType_t ) 0 );
+			xOffset = ( size_t ) ( pxQueue->pcWriteTo - pxQueue->pcHead );
+			xBack = ( size_t ) pxQueue->uxReserved * pxQueue->uxItemSize;
+		}
+		else
+		{
+			configASSERT( pxQueue->uxBorrowed > ( UBaseType_t ) 0 );
+			xOffset = ( size_t ) ( pxQueue->u.pcReadFrom - pxQueue->pcHead );
+			xBack = ( size_t ) ( pxQueue->uxBorrowed - ( UBaseType_t ) 1 ) * pxQueue->uxItemSize;
+		}
+
+		if( xBack > xOffset )
+		{
+			xOffset += xStorage;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+		configASSERT( pvItem == ( const void * ) ( pxQueue->pcHead + ( xOffset - xBack ) ) );
+		( void ) pvItem;
+
+		if( xReserve != pdFALSE )
+		{
+			/* The slot now holds a message, as after a copy to the back. */
+			( pxQueue->uxReserved )--;
+			( pxQueue->uxMessagesWaiting )++;
+
+			#if ( configUSE_QUEUE_SETS == 1 )
+			{
+				if( pxQueue->pxQueueSetContainer != NULL )
+				{
+					if( pxQueue->cTxLock == queueUNLOCKED )
+					{
+						xReturn = prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK );
+					}
+					else
+					{
+						pxQueue->cTxLock = ( int8_t ) ( pxQueue->cTxLock + 1 );
+					}
+				}
+				else
+				{
+					xReturn = prvWakeTasks( &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->cTxLock ), ( UBaseType_t ) 1 );
+				}
+			}
+			#else
+			{
+				xReturn = prvWakeTasks( &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->cTxLock ), ( UBaseType_t ) 1 );
+			}
+			#endif
+
+			/* A copy to the back waits while a reservation is outstanding,
+			even with room in the queue. */
+			if( pxQueue->uxReserved == ( UBaseType_t ) 0 )
+			{
+				xReturn |= prvWakeTasks( &( pxQueue->xTasksWaitingToSend ), &( pxQueue->cRxLock ), queueFREE_SLOTS( pxQueue ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			/* The slot is free, as after a receive. */
+			( pxQueue->uxBorrowed )--;
+
+			/* Reserving and copying tasks wait in the same list, and a woken
+			reserver would take the slot and leave the other tasks blocked
+			even if there is room for them too: one task per free slot. */
+			xReturn = prvWakeTasks( &( pxQueue->xTasksWaitingToSend ), &( pxQueue->cRxLock ), queueFREE_SLOTS( pxQueue ) );
+
+			/* A receive by copy waits while an item is borrowed, even with
+			messages in the queue. */
+			if( ( pxQueue->uxBorrowed == ( UBaseType_t ) 0 ) && ( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 ) )
+			{
+				xReturn |= prvWakeTasks( &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->cTxLock ), ( UBaseType_t ) 1 );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvIsLoanUnavailable( const Queue_t *pxQueue, const BaseType_t xReserve )
+	{
+	BaseType_t xReturn;
+
+		taskENTER_CRITICAL();
+		{
+			if( xReserve != pdFALSE )
+			{
+				xReturn = ( queueFREE_SLOTS( pxQueue ) == ( UBaseType_t ) 0 ) ? pdTRUE : pdFALSE;
+			}
+			else
+			{
+				xReturn = ( pxQueue->uxMessagesWaiting == ( UBaseType_t ) 0 ) ? pdTRUE : pdFALSE;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_LOANS */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue )
+{
+UBaseType_t uxReturn;
+
+	configASSERT( xQueue );
+
+	taskENTER_CRITICAL();
+	{
+		uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+	}
+	taskEXIT_CRITICAL();
+
+	return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueSpacesAvailable( const QueueHandle_t xQueue )
+{
+UBaseType_t uxReturn;
+Queue_t *pxQueue;
+
+	pxQueue = ( Queue_t * ) xQueue;
+	configASSERT( pxQueue );
+
+	taskENTER_CRITICAL();
+	{
+		#if ( configUSE_QUEUE_LOANS == 1 )
+		{
+			uxReturn = queueFREE_SLOTS( pxQueue );
+		}
+		#else
+		{
+			uxReturn = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
+		}
+		#endif
+	}
+	taskEXIT_CRITICAL();
+
+	return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueMessagesWaitingFromISR( const QueueHandle_t xQueue )
+{
+UBaseType_t uxReturn;
+
+	configASSERT( xQueue );
+
+	uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+
+	return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+void vQueueDelete( QueueHandle_t xQueue )
+{
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	traceQUEUE_DELETE( pxQueue );
+
+	#if ( configQUEUE_REGISTRY_SIZE > 0 )
+	{
+		vQueueUnregisterQueue( pxQueue );
+	}
+	#endif
+
+	#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
+	{
+		/* The queue can only have been allocated dynamically - free it
+		again. */
+		vPortFree( pxQueue );
+	}
+	#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+	{
+		/* The queue could have been allocated statically or dynamically, so
+		check before attempting to free the memory. */
+		if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+		{
+			vPortFree( pxQueue );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#else
+	{
+		/* The queue must have been statically allocated, so is not going to be
+		deleted.  Avoid compiler warnings about the unused parameter. */
+		( void ) pxQueue;
+	}
+	#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	UBaseType_t uxQueueGetQueueNumber( QueueHandle_t xQueue )
+	{
+		return ( ( Queue_t * ) xQueue )->uxQueueNumber;
+	}
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	void vQueueSetQueueNumber( QueueHandle_t xQueue, UBaseType_t uxQueueNumber )
+	{
+		( ( Queue_t * ) xQueue )->uxQueueNumber = uxQueueNumber;
+	}
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	uint8_t ucQueueGetQueueType( QueueHandle_t xQueue )
+	{
+		return ( ( Queue_t * ) xQueue )->ucQueueType;
+	}
 
 #endif /* configUSE_TRACE_FACILITY */
 /*-----------------------------------------------------------*/
@@ -1722,7 +2628,7 @@ UBaseType_t uxMessagesWaiting;
 	}
 	else if( xPosition == queueSEND_TO_BACK )
 	{
-		( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0. */
+		prvCopyItem( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0. */
 		pxQueue->pcWriteTo += pxQueue->uxItemSize;
 		if( pxQueue->pcWriteTo >= pxQueue->pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
 		{
@@ -1735,7 +2641,7 @@ UBaseType_t uxMessagesWaiting;
 	}
 	else
 	{
-		( void ) memcpy( ( void * ) pxQueue->u.pcReadFrom, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+		prvCopyItem( ( void * ) pxQueue->u.pcReadFrom, pvItemToQueue, pxQueue->uxItemSize ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
 		pxQueue->u.pcReadFrom -= pxQueue->uxItemSize;
 		if( pxQueue->u.pcReadFrom < pxQueue->pcHead ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
 		{
@@ -1786,8 +2692,123 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
-		( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.pcReadFrom, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0. */
+		prvCopyItem( pvBuffer, ( const void * ) pxQueue->u.pcReadFrom, pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0. */
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWakeTasks( List_t * const pxEventList, volatile int8_t * const pcLock, UBaseType_t uxCount )
+{
+UBaseType_t uxWaiting = listCURRENT_LIST_LENGTH( pxEventList );
+BaseType_t xReturn = pdFALSE;
+
+	/* No more than are waiting, which also bounds the lock count.  While the
+	queue is locked one more task may be about to join the list, as
+	prvUnlockQueue() expects. */
+	if( *pcLock != queueUNLOCKED )
+	{
+		uxWaiting++;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( uxCount > uxWaiting )
+	{
+		uxCount = uxWaiting;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	for( ; uxCount > ( UBaseType_t ) 0; uxCount-- )
+	{
+		/* The event lists are not altered if the queue is locked; the lock
+		count makes prvUnlockQueue() do it later. */
+		if( *pcLock == queueUNLOCKED )
+		{
+			if( xTaskRemoveFromEventList( pxEventList ) != pdFALSE )
+			{
+				xReturn = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			*pcLock = ( int8_t ) ( *pcLock + 1 );
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyItemsToQueue( Queue_t * const pxQueue, const void *pvItems, const UBaseType_t uxItems )
+{
+const size_t xBytes = ( size_t ) uxItems * ( size_t ) pxQueue->uxItemSize;
+const size_t xToEnd = ( size_t ) ( pxQueue->pcTail - pxQueue->pcWriteTo );
+
+	/* This function is called from a critical section. */
+
+	if( xBytes < xToEnd )
+	{
+		( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItems, xBytes );
+		pxQueue->pcWriteTo += xBytes;
+	}
+	else
+	{
+		( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItems, xToEnd );
+		( void ) memcpy( ( void * ) pxQueue->pcHead, ( const int8_t * ) pvItems + xToEnd, xBytes - xToEnd );
+		pxQueue->pcWriteTo = pxQueue->pcHead + ( xBytes - xToEnd );
+	}
+
+	pxQueue->uxMessagesWaiting += uxItems;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyItemsFromQueue( Queue_t * const pxQueue, void * const pvBuffer, const UBaseType_t uxItems )
+{
+const size_t xBytes = ( size_t ) uxItems * ( size_t ) pxQueue->uxItemSize;
+const size_t xStorage = ( size_t ) ( pxQueue->pcTail - pxQueue->pcHead );
+size_t xFrom, xToEnd;
+
+	if( uxItems == ( UBaseType_t ) 0U )
+	{
+		return;
+	}
+
+	/* pcReadFrom is the last item read, so the first one to copy follows
+	it. */
+	xFrom = ( size_t ) ( pxQueue->u.pcReadFrom - pxQueue->pcHead ) + pxQueue->uxItemSize;
+	if( xFrom >= xStorage )
+	{
+		xFrom = 0;
+	}
+	xToEnd = xStorage - xFrom;
+
+	if( xBytes <= xToEnd )
+	{
+		( void ) memcpy( pvBuffer, ( void * ) ( pxQueue->pcHead + xFrom ), xBytes );
+	}
+	else
+	{
+		( void ) memcpy( pvBuffer, ( void * ) ( pxQueue->pcHead + xFrom ), xToEnd );
+		( void ) memcpy( ( int8_t * ) pvBuffer + xToEnd, ( void * ) pxQueue->pcHead, xBytes - xToEnd );
+	}
+
+	/* Leave pcReadFrom on the last item copied. */
+	xFrom += xBytes - pxQueue->uxItemSize;
+	if( xFrom >= xStorage )
+	{
+		xFrom -= xStorage;
 	}
+	pxQueue->u.pcReadFrom = pxQueue->pcHead + xFrom;
+	pxQueue->uxMessagesWaiting -= uxItems;
 }
 /*-----------------------------------------------------------*/
 
@@ -1911,13 +2932,13 @@ static void prvUnlockQueue( Queue_t * const pxQueue )
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvIsQueueEmpty( const Queue_t *pxQueue )
+static BaseType_t prvIsQueueEmpty( const Queue_t *pxQueue, const BaseType_t xJustPeeking )
 {
 BaseType_t xReturn;
 
 	taskENTER_CRITICAL();
 	{
-		if( pxQueue->uxMessagesWaiting == ( UBaseType_t )  0 )
+		if( !queueCAN_RECEIVE( pxQueue, xJustPeeking ) )
 		{
 			xReturn = pdTRUE;
 		}
@@ -1950,13 +2971,13 @@ BaseType_t xReturn;
 } /*lint !e818 xQueue could not be pointer to const because it is a typedef. */
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvIsQueueFull( const Queue_t *pxQueue )
+static BaseType_t prvIsQueueFull( const Queue_t *pxQueue, const BaseType_t xCopyPosition )
 {
 BaseType_t xReturn;
 
 	taskENTER_CRITICAL();
 	{
-		if( pxQueue->uxMessagesWaiting == pxQueue->uxLength )
+		if( !queueCAN_SEND( pxQueue, xCopyPosition ) )
 		{
 			xReturn = pdTRUE;
 		}
@@ -2001,7 +3022,7 @@ BaseType_t xReturn;
 		between the check to see if the queue is full and blocking on the queue. */
 		portDISABLE_INTERRUPTS();
 		{
-			if( prvIsQueueFull( pxQueue ) != pdFALSE )
+			if( prvIsQueueFull( pxQueue, queueSEND_TO_BACK ) != pdFALSE )
 			{
 				/* The queue is full - do we want to block or just leave without
 				posting? */
@@ -535,6 +535,10 @@ typedef void * QueueSetMemberHandle_t;
  * Post an item on a queue.  If the queue is already full then overwrite the
  * value held in the queue.  The item is queued by copy, not by reference.
  *
+ * With configUSE_QUEUE_LOANS it must not be called while a slot of the queue
+ * is reserved or borrowed (see pvQueueReserve()): there is nothing it could
+ * overwrite without waiting or failing, so it asserts instead.
+ *
  * This function must not be called from an interrupt service routine.
  * See xQueueOverwriteFromISR () for an alternative which may be used in an ISR.
  *
@@ -1012,6 +1016,247 @@ BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue, void * const pvBuffer ) PRIV
  */
 BaseType_t xQueueGenericReceive( QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait, const BaseType_t xJustPeek ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>
+ BaseType_t xQueueSendMultiple(
+								QueueHandle_t xQueue,
+								const void *pvItems,
+								UBaseType_t uxItems,
+								TickType_t xTicksToWait
+							 );</pre>
+ *
+ * Post up to uxItems consecutive items to the back of a queue in one call:
+ * one critical section and the items copied as a single block, instead of
+ * the whole xQueueSend() path per item.  One waiting receiver is unblocked
+ * per item posted, as the same number of xQueueSend() calls would.  Meant for
+ * streams of small items (samples).
+ *
+ * Blocks, while the queue is full, in the same way as xQueueSend(); as soon
+ * as there is room it posts as many items as fit and returns, so fewer than
+ * uxItems may be posted.  Must not be used on a queue that is a member of a
+ * queue set.
+ *
+ * @param xQueue The handle to the queue.
+ *
+ * @param pvItems Pointer to an array of uxItems items.
+ *
+ * @param uxItems The number of items in pvItems.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for space, should the queue be full at the time of the call.
+ *
+ * @return The number of items posted, from the start of pvItems: 0 if the
+ * queue was still full after xTicksToWait.
+ *
+ * Example usage:
+   <pre>
+ void vSamplerTask( void *pvParameters )
+ {
+ uint16_t usSamples[ 16 ];
+ BaseType_t xSent;
+
+	for( ;; )
+	{
+		vReadSamples( usSamples, 16 );
+		for( xSent = 0; xSent < 16; )
+		{
+			xSent += xQueueSendMultiple( xQueue, &( usSamples[ xSent ] ), 16 - xSent, portMAX_DELAY );
+		}
+	}
+ }
+ </pre>
+ * \defgroup xQueueSendMultiple xQueueSendMultiple
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxItems, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ BaseType_t xQueueReceiveMultiple(
+								QueueHandle_t xQueue,
+								void *pvBuffer,
+								UBaseType_t uxItems,
+								TickType_t xTicksToWait
+							 );</pre>
+ *
+ * Receive up to uxItems items from the head of a queue in one call, with one
+ * critical section, unblocking one waiting sender per item taken.  Blocks,
+ * while the queue is empty, in the same way as xQueueReceive(); then takes
+ * the items that are there, up to uxItems, and returns.
+ *
+ * @param xQueue The handle to the queue.
+ *
+ * @param pvBuffer Buffer for uxItems items.
+ *
+ * @param uxItems The maximum number of items to receive.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item, should the queue be empty at the time of the call.
+ *
+ * @return The number of items copied to pvBuffer: 0 if the queue was still
+ * empty after xTicksToWait.
+ *
+ * \defgroup xQueueReceiveMultiple xQueueReceiveMultiple
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxItems, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Interrupt safe versions of xQueueSendMultiple() and xQueueReceiveMultiple():
+ * they never block, and set *pxHigherPriorityTaskWoken as xQueueSendFromISR()
+ * and xQueueReceiveFromISR() do.  Same return value.
+ */
+BaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxItems, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+BaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxItems, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_QUEUE_LOANS == 1 )
+
+/**
+ * queue. h
+ * <pre>
+ void *pvQueueReserve(
+						QueueHandle_t xQueue,
+						TickType_t xTicksToWait
+					 );</pre>
+ *
+ * This is a macro that calls pvQueueGenericLoan().  Only available if
+ * configUSE_QUEUE_LOANS is set to 1 in FreeRTOSConfig.h.
+ *
+ * Reserve the slot at the back of the queue so the item can be written in
+ * place, instead of being built in a buffer and copied in by xQueueSend()
+ * inside a critical section.  The item is not in the queue until
+ * vQueueCommit() is called.  Blocks, times out and unblocks in the same way
+ * as xQueueSend().
+ *
+ * Loans are taken and returned in order: commit the oldest reservation first.
+ * While a reservation is outstanding xQueueSend() and xQueueSendToBack() wait
+ * as if the queue was full, as their item has to go behind it, and
+ * xQueueOverwrite() must not be used.  Committing or releasing a loan wakes
+ * one waiting sender or reserver per free slot.
+ *
+ * @param xQueue The handle to the queue.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for a free slot.
+ *
+ * @return A pointer to uxItemSize bytes of queue storage, or NULL if the
+ * queue was still full after xTicksToWait.
+ *
+ * Example usage:
+   <pre>
+ struct ABlock
+ {
+	uint16_t usSamples[ 128 ];
+ };
+
+ void vProducerTask( void *pvParameters )
+ {
+ struct ABlock *pxBlock;
+
+	for( ;; )
+	{
+		pxBlock = pvQueueReserve( xQueue, portMAX_DELAY );
+		vFillBlock( pxBlock->usSamples );
+		vQueueCommit( xQueue, pxBlock );
+	}
+ }
+ </pre>
+ * \defgroup pvQueueReserve pvQueueReserve
+ * \ingroup QueueManagement
+ */
+#define pvQueueReserve( xQueue, xTicksToWait ) pvQueueGenericLoan( ( xQueue ), ( xTicksToWait ), pdTRUE )
+
+/**
+ * queue. h
+ * <pre>void vQueueCommit( QueueHandle_t xQueue, void *pvItem );</pre>
+ *
+ * Post the item written into a slot obtained from pvQueueReserve().  It
+ * unblocks a task waiting to receive as xQueueSend() would.
+ *
+ * @param xQueue The handle to the queue.
+ *
+ * @param pvItem The pointer returned by the oldest outstanding
+ * pvQueueReserve() on this queue.
+ *
+ * \defgroup pvQueueReserve pvQueueReserve
+ * \ingroup QueueManagement
+ */
+#define vQueueCommit( xQueue, pvItem ) vQueueGenericEndLoan( ( xQueue ), ( pvItem ), pdTRUE )
+
+/**
+ * queue. h
+ * <pre>
+ void *pvQueueBorrow(
+						QueueHandle_t xQueue,
+						TickType_t xTicksToWait
+					 );</pre>
+ *
+ * This is a macro that calls pvQueueGenericLoan().
+ *
+ * Receive the item at the head of the queue in place: it is removed from the
+ * queue as by xQueueReceive(), but its slot stays allocated until
+ * vQueueRelease(), so it can be read where it is.  Blocks, times out and
+ * unblocks in the same way as xQueueReceive().
+ *
+ * Borrowed items are released in order.  While one is outstanding
+ * xQueueReceive() waits as if the queue was empty and xQueueSendToFront()
+ * as if it was full (peeking still works).
+ *
+ * @param xQueue The handle to the queue.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item.
+ *
+ * @return A pointer to the item, or NULL if the queue was still empty after
+ * xTicksToWait.
+ *
+ * \defgroup pvQueueBorrow pvQueueBorrow
+ * \ingroup QueueManagement
+ */
+#define pvQueueBorrow( xQueue, xTicksToWait ) pvQueueGenericLoan( ( xQueue ), ( xTicksToWait ), pdFALSE )
+
+/**
+ * queue. h
+ * <pre>void vQueueRelease( QueueHandle_t xQueue, void *pvItem );</pre>
+ *
+ * Free the slot of an item obtained from pvQueueBorrow().  It unblocks a task
+ * waiting to send or reserve as xQueueReceive() would.
+ *
+ * @param xQueue The handle to the queue.
+ *
+ * @param pvItem The pointer returned by the oldest outstanding
+ * pvQueueBorrow() on this queue.
+ *
+ * \defgroup pvQueueBorrow pvQueueBorrow
+ * \ingroup QueueManagement
+ */
+#define vQueueRelease( xQueue, pvItem ) vQueueGenericEndLoan( ( xQueue ), ( pvItem ), pdFALSE )
+
+/*
+ * Interrupt safe versions of the above.  Reserving and borrowing never block
+ * (NULL if the queue is full or empty); committing and releasing set
+ * *pxHigherPriorityTaskWoken as xQueueSendFromISR() and xQueueReceiveFromISR()
+ * do.  A loan can be taken in an interrupt and returned by a task, or the
+ * other way round.
+ */
+#define pvQueueReserveFromISR( xQueue ) pvQueueGenericLoanFromISR( ( xQueue ), pdTRUE )
+#define vQueueCommitFromISR( xQueue, pvItem, pxHigherPriorityTaskWoken ) vQueueGenericEndLoanFromISR( ( xQueue ), ( pvItem ), pdTRUE, ( pxHigherPriorityTaskWoken ) )
+#define pvQueueBorrowFromISR( xQueue ) pvQueueGenericLoanFromISR( ( xQueue ), pdFALSE )
+#define vQueueReleaseFromISR( xQueue, pvItem, pxHigherPriorityTaskWoken ) vQueueGenericEndLoanFromISR( ( xQueue ), ( pvItem ), pdFALSE, ( pxHigherPriorityTaskWoken ) )
+
+/*
+ * The functions behind the macros above.  xReserve is pdTRUE to reserve and
+ * commit, pdFALSE to borrow and release.
+ */
+void *pvQueueGenericLoan( QueueHandle_t xQueue, TickType_t xTicksToWait, const BaseType_t xReserve ) PRIVILEGED_FUNCTION;
+void vQueueGenericEndLoan( QueueHandle_t xQueue, const void * const pvItem, const BaseType_t xReserve ) PRIVILEGED_FUNCTION;
+void *pvQueueGenericLoanFromISR( QueueHandle_t xQueue, const BaseType_t xReserve ) PRIVILEGED_FUNCTION;
+void vQueueGenericEndLoanFromISR( QueueHandle_t xQueue, const void * const pvItem, const BaseType_t xReserve, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_QUEUE_LOANS */
+
 /**
  * queue. h
  * <pre>UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue );</pre>
@@ -1217,6 +1462,7 @@ void vQueueDelete( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
  *
  * Post an item on a queue.  If the queue is already full then overwrite the
  * value held in the queue.  The item is queued by copy, not by reference.
+ * Not while a loan on the queue is outstanding, as xQueueOverwrite().
  *
  * @param xQueue The handle to the queue on which the item is to be posted.
  *
@@ -2258,6 +2258,31 @@ eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
  */
 void *pvTaskIncrementMutexHeldCount( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * For internal use only.  The counterpart of pvTaskIncrementMutexHeldCount()
+ * for mutexes that are given back outside of a critical section.  Decrements
+ * the mutex held count of the calling task and, if that was the last mutex
+ * held while running at an inherited priority, disinherits it as
+ * xTaskPriorityDisinherit() does.
+ */
+void vTaskDecrementMutexHeldCount( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * For internal use only.  Priority ceiling protocol, both called from a
+ * critical section by the task taking or giving the mutex.
+ * pvTaskPriorityRaiseToCeiling() increments the mutex held count, raises the
+ * running task to uxCeiling if it runs below it, stores the priority it ran
+ * at in *puxPreviousPriority and the new held count in *puxMutexesHeld, and
+ * returns its handle.  The task's base priority must not exceed uxCeiling.
+ * xTaskPriorityLowerFromCeiling() takes both values back, asserts that the
+ * held count is unchanged (mutexes given in reverse order of taking),
+ * decrements the count and lowers the task back to uxPreviousPriority, or to
+ * its base priority if it holds no other mutex; it returns pdTRUE if a
+ * context switch may be required.
+ */
+void *pvTaskPriorityRaiseToCeiling( const UBaseType_t uxCeiling, UBaseType_t * const puxPreviousPriority, UBaseType_t * const puxMutexesHeld ) PRIVILEGED_FUNCTION;
+BaseType_t xTaskPriorityLowerFromCeiling( const UBaseType_t uxCeiling, const UBaseType_t uxPreviousPriority, const UBaseType_t uxMutexesHeld ) PRIVILEGED_FUNCTION;
+
 #ifdef __cplusplus
 }
 #endif
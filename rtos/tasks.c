@@ -579,6 +579,17 @@ static void prvInitialiseNewTask( 	TaskFunction_t pxTaskCode,
  */
 static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_MUTEXES == 1 )
+
+	/*
+	 * Moves the running task to the ready list of uxNewPriority without
+	 * touching its base priority, as priority inheritance does.  Called from
+	 * a critical section.
+	 */
+	static void prvSetCurrentTaskPriority( const UBaseType_t uxNewPriority ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 #if( configSUPPORT_STATIC_ALLOCATION == 1 )
@@ -4190,6 +4201,146 @@ TickType_t uxReturn;
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_MUTEXES == 1 )
+
+	void vTaskDecrementMutexHeldCount( void )
+	{
+		configASSERT( pxCurrentTCB->uxMutexesHeld );
+
+		/* Only the running task changes its own mutex held count, so the
+		count can be decremented without a critical section.  The priority
+		cannot be inherited through a mutex the task has already given back,
+		so if it is inherited now the task holds other mutexes, or holds none
+		any more and the priority must be restored - which does need the
+		critical section. */
+		if( ( pxCurrentTCB->uxMutexesHeld == ( UBaseType_t ) 1 ) && ( pxCurrentTCB->uxPriority != pxCurrentTCB->uxBasePriority ) )
+		{
+			taskENTER_CRITICAL();
+			{
+				if( xTaskPriorityDisinherit( pxCurrentTCB ) != pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+		else
+		{
+			( pxCurrentTCB->uxMutexesHeld )--;
+		}
+	}
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEXES == 1 )
+
+	static void prvSetCurrentTaskPriority( const UBaseType_t uxNewPriority )
+	{
+		/* The running task is always in a ready list. */
+		if( uxListRemove( &( pxCurrentTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
+		{
+			taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxCurrentTCB->uxPriority = uxNewPriority;
+
+		/* The event list item cannot be in use while the task is running. */
+		listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xEventListItem ), ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxNewPriority ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+		prvAddTaskToReadyList( pxCurrentTCB );
+	}
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEXES == 1 )
+
+	void *pvTaskPriorityRaiseToCeiling( const UBaseType_t uxCeiling, UBaseType_t * const puxPreviousPriority, UBaseType_t * const puxMutexesHeld )
+	{
+		configASSERT( uxCeiling < ( UBaseType_t ) configMAX_PRIORITIES );
+
+		/* The ceiling must be at least the priority of every task that takes
+		the mutex, or the protocol does not bound blocking. */
+		configASSERT( pxCurrentTCB->uxBasePriority <= uxCeiling );
+
+		( pxCurrentTCB->uxMutexesHeld )++;
+		*puxMutexesHeld = pxCurrentTCB->uxMutexesHeld;
+		*puxPreviousPriority = pxCurrentTCB->uxPriority;
+
+		/* Raising the running task never requires a context switch. */
+		if( pxCurrentTCB->uxPriority < uxCeiling )
+		{
+			prvSetCurrentTaskPriority( uxCeiling );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pxCurrentTCB;
+	}
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEXES == 1 )
+
+	BaseType_t xTaskPriorityLowerFromCeiling( const UBaseType_t uxCeiling, const UBaseType_t uxPreviousPriority, const UBaseType_t uxMutexesHeld )
+	{
+	UBaseType_t uxNewPriority;
+	BaseType_t xReturn = pdFALSE;
+
+		/* uxPreviousPriority is only right if the mutex is given in the
+		reverse order it was taken: every mutex taken after it, of any kind,
+		must have been given already. */
+		configASSERT( pxCurrentTCB->uxMutexesHeld == uxMutexesHeld );
+		( pxCurrentTCB->uxMutexesHeld )--;
+
+		if( pxCurrentTCB->uxMutexesHeld == ( UBaseType_t ) 0 )
+		{
+			/* Nothing held, so nothing can justify a raised priority - this
+			also drops a priority inherited through a mutex that was given
+			back while this one was held. */
+			uxNewPriority = pxCurrentTCB->uxBasePriority;
+		}
+		else if( pxCurrentTCB->uxPriority == uxCeiling )
+		{
+			/* Back to the priority the mutex was taken at, which the mutexes
+			still held may require. */
+			uxNewPriority = uxPreviousPriority;
+		}
+		else
+		{
+			/* Raised above the ceiling through a mutex that is still held. */
+			uxNewPriority = pxCurrentTCB->uxPriority;
+		}
+
+		if( uxNewPriority != pxCurrentTCB->uxPriority )
+		{
+			/* A task that became ready while this one ran at the higher
+			priority may now have to run. */
+			prvSetCurrentTaskPriority( uxNewPriority );
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_MUTEXES */
+/*-----------------------------------------------------------*/
+
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
 	uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
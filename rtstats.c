@@ -0,0 +1,135 @@
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "rtstats.h"
+
+#if RTSTATS
+
+struct rtstats_estado rtstats;
+
+void rtstats_cerrar_subventana(uint32_t ahora)
+{
+	/* La cerrada ocupa en el anillo el sitio de la que sale de la ventana */
+	const unsigned k = rtstats.subventanas % RTSTATS_SUBVENTANAS;
+
+	for (unsigned i = 0; i <= RTSTATS_MAX_TAREAS; ++i) {
+		struct rtstats_hueco *h = &rtstats.hueco[i];
+		h->ventana += h->sub - h->anillo[k];
+		h->anillo[k] = h->sub;
+		h->sub = 0;
+	}
+	const uint32_t len = ahora - rtstats.t_sub;
+	rtstats.ventana += len - rtstats.anillo[k];
+	rtstats.anillo[k] = len;
+	rtstats.t_sub = ahora;
+	rtstats.subventanas++;
+}
+
+void rtstats_init(void)
+{
+	ciclos_init();
+	uint32_t ahora = ciclos_leer();
+
+	for (unsigned i = 0; i <= RTSTATS_MAX_TAREAS; ++i) {
+		void *tarea = rtstats.hueco[i].tarea;	// Ya creadas
+		rtstats.hueco[i] = (struct rtstats_hueco){ .tarea = tarea };
+	}
+	for (unsigned k = 0; k < RTSTATS_SUBVENTANAS; ++k)
+		rtstats.anillo[k] = 0;
+	rtstats.t_cambio = rtstats.t_rafaga = rtstats.t_sub = ahora;
+	rtstats.ventana = 0;
+	rtstats.subventanas = 0;
+	rtstats.actual = 0;
+}
+
+static unsigned __leer(struct rtstats_info *info, unsigned n,
+		       uint32_t *subventanas, uint32_t *ventana)
+{
+	if (n > RTSTATS_MAX_TAREAS + 1)
+		n = RTSTATS_MAX_TAREAS + 1;
+
+	taskENTER_CRITICAL();
+	{
+		/* Cierra el tramo de la tarea que llama, como un cambio de
+		 * contexto a sí misma (no corta su ráfaga) */
+		rtstats_contar(ciclos_leer(), rtstats.actual);
+
+		const uint32_t len = rtstats.ventana;
+		for (unsigned i = 0; i < n; ++i) {
+			const struct rtstats_hueco *h = &rtstats.hueco[i];
+			info[i].tarea = h->tarea;
+			info[i].total = h->total;
+			info[i].max_rafaga = h->max_rafaga;
+			info[i].carga = len ? (uint16_t)(((uint64_t)h->ventana * 10000U +
+							  len / 2) / len) : 0;
+		}
+		/* Ráfaga en curso de la tarea que llama */
+		if (rtstats.actual < n) {
+			uint32_t r = rtstats.t_cambio - rtstats.t_rafaga;
+			if (r > info[rtstats.actual].max_rafaga)
+				info[rtstats.actual].max_rafaga = r;
+		}
+		*subventanas = rtstats.subventanas;
+		*ventana = len;
+	}
+	taskEXIT_CRITICAL();
+
+	/* Huecos usados: el 0 y los de las tareas creadas */
+	unsigned usados = 1;
+	for (unsigned i = 1; i < n; ++i)
+		if (info[i].tarea != NULL)
+			usados = i + 1;
+	return usados;
+}
+
+unsigned rtstats_leer(struct rtstats_info *info, unsigned n)
+{
+	uint32_t subventanas, len;
+
+	return __leer(info, n, &subventanas, &len);
+}
+
+static uint8_t *__put16(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	return p + 2;
+}
+
+static uint8_t *__put32(uint8_t *p, uint32_t v)
+{
+	return __put16(__put16(p, v), v >> 16);
+}
+
+size_t rtstats_volcar(uint8_t *buf, size_t len)
+{
+	struct rtstats_info info[RTSTATS_MAX_TAREAS + 1];
+	uint32_t subventanas, ventana;
+	unsigned n = __leer(info, RTSTATS_MAX_TAREAS + 1, &subventanas, &ventana);
+	size_t total = RTSTATS_VOLCADO_CABECERA + n * RTSTATS_VOLCADO_HUECO;
+
+	if (len < total)
+		return 0;
+
+	uint8_t *p = buf;
+	*p++ = 'R';
+	*p++ = 'T';
+	*p++ = 'S';
+	*p++ = RTSTATS_VOLCADO_VERSION;
+	*p++ = (uint8_t)n;
+	*p++ = 0;
+	p = __put16(p, subventanas);
+	p = __put32(p, ventana);
+
+	for (unsigned i = 0; i < n; ++i) {
+		*p++ = (uint8_t)i;
+		*p++ = 0;
+		p = __put16(p, info[i].carga);
+		p = __put32(p, info[i].max_rafaga);
+		p = __put32(p, (uint32_t)info[i].total);
+		p = __put32(p, (uint32_t)(info[i].total >> 32));
+	}
+	return total;
+}
+
+#endif // RTSTATS
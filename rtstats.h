@@ -0,0 +1,169 @@
+#ifndef RTSTATS_H
+#define RTSTATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ciclos.h"
+
+/*
+ * Estadísticas de tiempo de CPU por tarea (RTSTATS = 1).
+ *
+ * El kernel llama a rtstats_switch_in() en cada cambio de contexto
+ * (traceTASK_SWITCHED_IN, ver FreeRTOSConfig.h) con el número de la
+ * tarea que entra; el tiempo desde el cambio anterior se suma a la que
+ * sale, medido con ciclos.h (DWT_CYCCNT en el target, el TSC en el
+ * host). Por cada tarea:
+ *
+ *	total		ciclos acumulados desde rtstats_init()
+ *	max_rafaga	máximo de ciclos seguidos sin ceder la CPU
+ *	carga		% de la ventana deslizante: las últimas
+ *			RTSTATS_SUBVENTANAS subventanas cerradas, de
+ *			RTSTATS_VENTANA_CICLOS en total
+ *
+ * Las interrupciones cuentan para la tarea a la que interrumpen.
+ *
+ * La ventana avanza de subventana en subventana: cada tarea guarda un
+ * anillo con sus ciclos en las últimas RTSTATS_SUBVENTANAS y la suma de
+ * ellas, que se corrige al cerrar cada una (sumar la nueva, restar la que
+ * sale), sin recorrer el anillo.
+ *
+ * Coste en vTaskSwitchContext: una lectura del contador, una suma de 64
+ * bits y dos comparaciones; al cerrar una subventana (8 por segundo) un
+ * bucle por las tareas. Los huecos se indexan con uxTCBNumber (orden
+ * de creación, configUSE_TRACE_FACILITY): el 0 acumula lo anterior al
+ * scheduler y las tareas que no caben.
+ */
+
+#ifndef RTSTATS_MAX_TAREAS
+#define RTSTATS_MAX_TAREAS	8
+#endif
+
+/* Longitud de la ventana de carga: 1 s a 72 MHz */
+#ifndef RTSTATS_VENTANA_CICLOS
+#define RTSTATS_VENTANA_CICLOS	72000000UL
+#endif
+
+/* Pasos en que avanza la ventana: 8 de 125 ms */
+#ifndef RTSTATS_SUBVENTANAS
+#define RTSTATS_SUBVENTANAS	8
+#endif
+
+#define RTSTATS_SUBVENTANA_CICLOS	(RTSTATS_VENTANA_CICLOS / RTSTATS_SUBVENTANAS)
+
+struct rtstats_hueco {
+	uint64_t total;
+	uint32_t max_rafaga;
+	uint32_t sub;			// Ciclos en la subventana en curso
+	uint32_t ventana;		// Suma de anillo[]
+	uint32_t anillo[RTSTATS_SUBVENTANAS];	// Por subventana cerrada
+	void *tarea;			// TaskHandle_t
+};
+
+struct rtstats_estado {
+	uint32_t t_cambio;		// Último cambio de contexto
+	uint32_t t_rafaga;		// Entrada de la tarea en marcha
+	uint32_t t_sub;			// Inicio de la subventana en curso
+	uint32_t ventana;		// Longitud de la ventana: suma de anillo[]
+	uint32_t anillo[RTSTATS_SUBVENTANAS];	// Longitud de cada subventana
+	uint32_t subventanas;		// Subventanas cerradas
+	unsigned actual;		// Hueco de la tarea en marcha
+	struct rtstats_hueco hueco[RTSTATS_MAX_TAREAS + 1];
+};
+
+extern struct rtstats_estado rtstats;
+
+/**
+ * @brief Cierra la subventana en curso y avanza la ventana de carga
+ *        (sólo desde el kernel o dentro de una sección crítica).
+ */
+void rtstats_cerrar_subventana(uint32_t ahora);
+
+/**
+ * @brief Cuenta el tiempo hasta 'ahora' para la tarea en marcha y pasa
+ *        al hueco 'n' (mismo contexto que rtstats_cerrar_subventana()).
+ */
+static inline void rtstats_contar(uint32_t ahora, unsigned n)
+{
+	struct rtstats_hueco *h = &rtstats.hueco[rtstats.actual];
+	uint32_t d = ahora - rtstats.t_cambio;
+
+	h->total += d;
+	h->sub += d;
+	rtstats.t_cambio = ahora;
+
+	if (n > RTSTATS_MAX_TAREAS)
+		n = 0;
+	if (n != rtstats.actual) {
+		uint32_t r = ahora - rtstats.t_rafaga;
+		if (r > h->max_rafaga)
+			h->max_rafaga = r;
+		rtstats.t_rafaga = ahora;
+		rtstats.actual = n;
+	}
+
+	if (ahora - rtstats.t_sub >= RTSTATS_SUBVENTANA_CICLOS)
+		rtstats_cerrar_subventana(ahora);
+}
+
+/* traceTASK_SWITCHED_IN: 'n' = uxTCBNumber de la tarea que entra */
+static inline void rtstats_switch_in(unsigned n)
+{
+	rtstats_contar(ciclos_leer(), n);
+}
+
+/* traceTASK_CREATE: recuerda el handle de cada hueco */
+static inline void rtstats_creada(void *tarea, unsigned n)
+{
+	if (n <= RTSTATS_MAX_TAREAS)
+		rtstats.hueco[n].tarea = tarea;
+}
+
+/**
+ * @brief Arranca el contador de ciclos y pone las estadísticas a cero.
+ *
+ * Antes de vTaskStartScheduler().
+ */
+void rtstats_init(void);
+
+struct rtstats_info {
+	void *tarea;			// TaskHandle_t; NULL en el hueco 0
+	uint64_t total;			// Ciclos
+	uint32_t max_rafaga;		// Ciclos
+	uint16_t carga;			// Centésimas de %, en la ventana
+};
+
+/**
+ * @brief Copia las estadísticas de los huecos 0..n-1 (desde una tarea).
+ *
+ * Incluye el tiempo en curso de la tarea que llama.
+ * @return Número de huecos copiados (tareas creadas + 1, como mucho n).
+ */
+unsigned rtstats_leer(struct rtstats_info *info, unsigned n);
+
+/*
+ * Volcado binario (little-endian), para sacarlo por un puerto serie o
+ * leerlo de la RAM con el depurador:
+ *
+ *	0	"RTS", versión (2)
+ *	4	u8 huecos, u8 0, u16 subventanas cerradas (16 bits bajos)
+ *	8	u32 longitud de la ventana, en ciclos
+ *	12	por hueco, 16 bytes:
+ *		u8 número (uxTCBNumber; 0 = otros), u8 0, u16 carga (0.01 %),
+ *		u32 max_rafaga, u64 total
+ */
+#define RTSTATS_VOLCADO_VERSION	2
+#define RTSTATS_VOLCADO_CABECERA	12U
+#define RTSTATS_VOLCADO_HUECO	16U
+#define RTSTATS_VOLCADO_MAX \
+	(RTSTATS_VOLCADO_CABECERA + (RTSTATS_MAX_TAREAS + 1) * RTSTATS_VOLCADO_HUECO)
+
+/**
+ * @brief Escribe el volcado binario en 'buf' (desde una tarea).
+ *
+ * Usa unos (RTSTATS_MAX_TAREAS + 1) * 24 bytes de pila.
+ * @return Bytes escritos, o 0 si 'len' no alcanza.
+ */
+size_t rtstats_volcar(uint8_t *buf, size_t len);
+
+#endif // RTSTATS_H
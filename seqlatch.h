@@ -0,0 +1,70 @@
+#ifndef SEQLATCH_H
+#define SEQLATCH_H
+
+#include <stdint.h>
+
+/*
+ * Publicación sin bloqueos (un escritor, varios lectores) con
+ * "seqcount latch": un contador de secuencia y DOS copias del dato.
+ *
+ * El escritor actualiza primero la copia [0] y luego la [1]; el bit 0 del
+ * contador indica a los lectores cuál de las dos está estable en cada
+ * momento, así que un lector nunca espera a que el escritor termine:
+ *
+ *	Escritor (una sola tarea o ISR):
+ *		seqlatch_write_begin(&l);	dato[0] = nuevo;
+ *		seqlatch_write_next(&l);	dato[1] = nuevo;
+ *
+ *	Lector (tareas e ISRs):
+ *		uint32_t s;
+ *		do {
+ *			s = seqlatch_read_begin(&l);
+ *			copia = dato[seqlatch_index(s)];
+ *		} while (seqlatch_read_retry(&l, s));
+ *
+ * Un lector en una ISR que interrumpe al escritor lee la copia que éste
+ * no está tocando y no reintenta nunca. Un lector en una tarea sólo
+ * reintenta si se publicó un valor nuevo durante su copia.
+ *
+ * Núcleo único (Cortex-M3): basta con barreras de compilador entre los
+ * accesos; el hardware no reordena lo que ve una ISR del mismo núcleo.
+ */
+
+struct seqlatch {
+	volatile uint32_t seq;
+};
+
+#define seqlatch_barrier()	__atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+static inline void seqlatch_write_begin(struct seqlatch *l)
+{
+	l->seq++;		// Impar: los lectores usan la copia [1]
+	seqlatch_barrier();
+}
+
+static inline void seqlatch_write_next(struct seqlatch *l)
+{
+	seqlatch_barrier();
+	l->seq++;		// Par: los lectores usan la copia [0]
+	seqlatch_barrier();
+}
+
+static inline uint32_t seqlatch_read_begin(const struct seqlatch *l)
+{
+	uint32_t s = l->seq;
+	seqlatch_barrier();
+	return s;
+}
+
+static inline unsigned seqlatch_index(uint32_t s)
+{
+	return s & 1U;
+}
+
+static inline int seqlatch_read_retry(const struct seqlatch *l, uint32_t s)
+{
+	seqlatch_barrier();
+	return l->seq != s;
+}
+
+#endif // SEQLATCH_H
@@ -0,0 +1,156 @@
+#include "sweep.h"
+
+#define F_MAX_BITS	31	// k y f << s caben en 31 bits (k + f / 2 en 32)
+#define LN2_Q16		45426	// ln(2) en Q16
+
+/* log2(num / den) en Q16 (sólo configuración) */
+static int32_t __log2_q16(uint32_t num, uint32_t den)
+{
+	uint64_t x = ((uint64_t)num << 32) / den;	// Q32
+	int32_t ent = 0;
+
+	/* Normaliza a [1, 2) */
+	while (x >= (2ULL << 32)) {
+		x >>= 1;
+		ent++;
+	}
+	while (x < (1ULL << 32)) {
+		x <<= 1;
+		ent--;
+	}
+
+	/* Bits fraccionarios elevando al cuadrado (y en Q31) */
+	uint32_t y = (uint32_t)(x >> 1);
+	int32_t frac = 0;
+	for (int i = 0; i < 16; ++i) {
+		uint64_t yy = ((uint64_t)y * y) >> 31;
+		frac <<= 1;
+		if (yy >= (2ULL << 31)) {
+			frac |= 1;
+			yy >>= 1;
+		}
+		y = (uint32_t)yy;
+	}
+	return ent * 65536 + frac;
+}
+
+/*
+ * Incremento de f en un período de la ley logarítmica:
+ * f * (e^x - 1) ≈ f * (x + x^2/2 + x^3/6 + x^4/24), con x = ln(f1/f0) *
+ * N / T en Q31 (|x| < 1/2). Sigue el período real de N cuentas, así que
+ * no deriva.
+ */
+static inline int64_t __exp_step(int64_t f, int64_t x)
+{
+	int64_t x2 = (x * x) >> 31;
+	int64_t x3 = (x2 * x) >> 31;
+	int64_t x4 = (x3 * x) >> 31;
+	int64_t e = x + x2 / 2 + x3 / 6 + x4 / 24;
+
+	return (f >> 31) * e + (((f & 0x7FFFFFFF) * e) >> 31);
+}
+
+int sweep_init(struct sweep *sw, const struct sweep_config *cfg,
+	       uint32_t clock_hz)
+{
+	const uint32_t f0 = cfg->f_inicio_hz, f1 = cfg->f_fin_hz;
+	const uint32_t f_min = f0 < f1 ? f0 : f1;
+	const uint32_t f_max = f0 < f1 ? f1 : f0;
+
+	if (f_min == 0 || cfg->duracion_ms == 0)
+		return -1;
+
+	/* PSC fijo: el menor con el que f_min cabe en ARR de 16 bits */
+	uint32_t p = (uint32_t)(((uint64_t)clock_hz + 65536ULL * f_min - 1) /
+				(65536ULL * f_min));
+	if (p == 0)
+		p = 1;
+	if (p > 65536 || (uint64_t)f_max * p * 2 > clock_hz)
+		return -1;	// Menos de 2 cuentas por período a f_max
+
+	/* Máxima resolución de frecuencia con k < 2^31 */
+	uint32_t s = 0;
+	while ((((uint64_t)clock_hz << (s + 1)) / p) < (1ULL << F_MAX_BITS))
+		s++;
+
+	sw->psc = p - 1;
+	sw->k = (uint32_t)(((uint64_t)clock_hz << s) / p);
+	sw->s = s;
+	sw->ley = cfg->ley;
+	sw->t_fin = (uint64_t)cfg->duracion_ms * clock_hz / (1000ULL * p);
+	sw->f_inicio = (int64_t)f0 << (s + 32);
+	sw->f_fin = (int64_t)f1 << (s + 32);
+	sw->duty_q16 = cfg->duty_q16 > 65536 ? 65536 : cfg->duty_q16;
+	sw->repetir = cfg->repetir;
+
+	if (cfg->ley == SWEEP_LOG) {
+		/*
+		 * f = f0 * e^(ln(f1/f0) * t / T): por período de N cuentas
+		 * f se multiplica por e^x, x = paso * N >> 48. El período más
+		 * largo (a f_min) no puede pasar de x = 1/2: |ln(f1/f0)| *
+		 * N_max < T / 2.
+		 */
+		int64_t ln_q16 = ((int64_t)__log2_q16(f1, f0) * LN2_Q16) >> 16;
+		uint64_t ln_abs = (uint64_t)(ln_q16 < 0 ? -ln_q16 : ln_q16);
+		uint32_t n_max = (uint32_t)(clock_hz / ((uint64_t)p * f_min));
+
+		sw->paso = (int64_t)((ln_abs << 32) / sw->t_fin);
+		if ((((uint64_t)sw->paso * (n_max + 1)) >> 17) >= (1ULL << 30))
+			return -1;
+		if (ln_q16 < 0)
+			sw->paso = -sw->paso;
+	} else {
+		sw->paso = (sw->f_fin - sw->f_inicio) / (int64_t)sw->t_fin;
+	}
+
+	sw->f = sw->f_inicio;
+	sw->t = 0;
+	sw->terminado = 0;
+	return 0;
+}
+
+void sweep_fill(struct sweep *sw, volatile uint16_t *buf, unsigned periods)
+{
+	int64_t f = sw->f;
+	uint64_t t = sw->t;
+
+	for (unsigned i = 0; i < periods; ++i, buf += SWEEP_PALABRAS) {
+		uint32_t f_q = (uint32_t)(f >> 32);	// Hz << s
+		uint32_t n = f_q ? (sw->k + f_q / 2) / f_q : 65536;
+
+		if (n > 65536) n = 65536;
+		if (n < 2) n = 2;
+
+		/* CCR1 llega a ARR + 1 = n con el 100%, que con n = 65536 no
+		 * cabe en 16 bits: ahí queda en 65535/65536 (como pwm_dither.c) */
+		uint32_t ccr = (uint32_t)(((uint64_t)n * sw->duty_q16) >> 16);
+		if (ccr > 0xFFFF) ccr = 0xFFFF;
+
+		buf[0] = (uint16_t)(n - 1);		// ARR
+		buf[1] = 0;				// RCR
+		buf[2] = (uint16_t)ccr;			// CCR1
+
+		if (sw->terminado)
+			continue;
+
+		/* Avanza la ley el tiempo real de este período: n cuentas */
+		t += n;
+		if (sw->ley == SWEEP_LOG)
+			f += __exp_step(f, (sw->paso * (int64_t)n) >> 17);
+		else
+			f += sw->paso * (int64_t)n;
+
+		if (t >= sw->t_fin) {
+			if (sw->repetir) {
+				t = 0;
+				f = sw->f_inicio;
+			} else {
+				f = sw->f_fin;
+				sw->terminado = 1;
+			}
+		}
+	}
+
+	sw->f = f;
+	sw->t = t;
+}
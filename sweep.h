@@ -0,0 +1,78 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+
+/*
+ * Barridos de frecuencia (chirp) lineales y logarítmicos en el TIM1.
+ *
+ * Se generan período a período los valores {ARR, RCR, CCR1} de cada
+ * ciclo del PWM y el DMA los carga con una ráfaga por TIM1_DMAR en cada
+ * evento de actualización (ver hal_pwm_sweep_start()). Cada período dura
+ * exactamente ARR + 1 cuentas del timer, y la ley del barrido se evalúa
+ * sobre el tiempo acumulado en cuentas, así que la duración y la
+ * frecuencia en cada instante no dependen del RTOS ni derivan: sólo se
+ * redondea cada período a una cuenta entera.
+ *
+ *	Lineal:		f(t) = f0 + (f1 - f0) * t / T
+ *	Logarítmico:	f(t) = f0 * (f1 / f0)^(t / T)
+ *
+ * El PSC es fijo durante el barrido (el de la frecuencia más baja) y la
+ * frecuencia se lleva en punto fijo adaptado a él. Por período: una
+ * división de 32 bits y unas pocas multiplicaciones, sin float.
+ */
+
+enum sweep_ley {
+	SWEEP_LINEAL,
+	SWEEP_LOG,
+};
+
+struct sweep_config {
+	uint32_t f_inicio_hz;
+	uint32_t f_fin_hz;
+	uint32_t duracion_ms;
+	enum sweep_ley ley;
+	uint32_t duty_q16;	// Duty constante (65536 = 100%)
+	int repetir;		// 1 = vuelve a empezar al terminar
+};
+
+/* Medias palabras por período en el búfer: ARR, RCR, CCR1 */
+#define SWEEP_PALABRAS	3U
+
+struct sweep {
+	/* Fijado por sweep_init() */
+	uint32_t psc;
+	uint32_t k;		// (reloj / (PSC + 1)) << s
+	uint32_t s;		// Bits fraccionarios de la frecuencia
+	enum sweep_ley ley;
+	int64_t paso;		// Lineal: Δf por cuenta; log: ln(f1/f0) / T, Q48
+	uint64_t t_fin;		// Duración en cuentas del timer
+	int64_t f_inicio;	// Frecuencias en Hz << (s + 32)
+	int64_t f_fin;
+	uint32_t duty_q16;
+	int repetir;
+
+	/* Estado (sweep_fill) */
+	int64_t f;
+	uint64_t t;		// Cuentas desde el inicio
+	volatile int terminado;
+};
+
+/**
+ * @brief Prepara un barrido para un timer de 16 bits con reloj 'clock_hz'.
+ * @return 0, o -1 si la configuración no es realizable (frecuencias
+ *         fuera de rango, o un barrido logarítmico demasiado corto).
+ */
+int sweep_init(struct sweep *sw, const struct sweep_config *cfg,
+	       uint32_t clock_hz);
+
+/**
+ * @brief Genera los 'periods' períodos siguientes en 'buf'
+ *        (SWEEP_PALABRAS medias palabras por período).
+ *
+ * Al llegar a la duración vuelve a empezar (repetir) o se queda en
+ * f_fin y marca 'terminado'.
+ */
+void sweep_fill(struct sweep *sw, volatile uint16_t *buf, unsigned periods);
+
+#endif // SWEEP_H
@@ -0,0 +1,147 @@
+#include <string.h>
+#ifdef HOST_PORT
+#include <time.h>
+#endif
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "traza.h"
+
+#if TRAZA
+
+struct traza_estado traza;
+
+static uint32_t reloj_hz = configCPU_CLOCK_HZ;
+
+#define traza_barrier()	__atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+#if defined(HOST_PORT) && (defined(__x86_64__) || defined(__i386__))
+/* Frecuencia del TSC: ~20 ms contra CLOCK_MONOTONIC */
+static uint32_t __calibrar_tsc(void)
+{
+	struct timespec t0, t1;
+	uint32_t c0 = ciclos_leer();
+	double ns;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	do {
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		ns = (double)(t1.tv_sec - t0.tv_sec) * 1e9 +
+		     (double)(t1.tv_nsec - t0.tv_nsec);
+	} while (ns < 20e6);
+	return (uint32_t)((double)(ciclos_leer() - c0) * 1e9 / ns);
+}
+#endif
+
+void traza_init(void)
+{
+	ciclos_init();
+#ifdef HOST_PORT
+#if defined(__x86_64__) || defined(__i386__)
+	reloj_hz = __calibrar_tsc();
+#else
+	reloj_hz = 1000000000UL;
+#endif
+#endif
+	traza.pos = 0;
+	traza.leido = 0;
+	traza.cabecera = 0;
+	traza.activa = 1;
+}
+
+static void __put32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+static size_t __cabecera(traza_escribir_t escribir, void *ctx, uint32_t perdidos)
+{
+	uint8_t c[16];
+	unsigned n = 0;
+
+	for (unsigned i = 1; i <= TRAZA_MAX_TAREAS; ++i)
+		if (traza.tarea[i] != NULL)
+			n = i;
+
+	memcpy(c, "TRZ", 3);
+	c[3] = TRAZA_VERSION;
+	__put32(&c[4], reloj_hz);
+	c[8] = (uint8_t)n;
+	c[9] = TRAZA_LOG2;
+	c[10] = c[11] = 0;
+	__put32(&c[12], perdidos);
+	escribir(c, sizeof(c), ctx);
+
+	for (unsigned i = 1; i <= n; ++i) {
+		memset(c, 0, sizeof(c));
+		c[0] = (uint8_t)i;
+		if (traza.tarea[i] != NULL)
+			strncpy((char *)&c[1], pcTaskGetName(traza.tarea[i]), 14);
+		escribir(c, sizeof(c), ctx);
+	}
+	return 16U * (n + 1);
+}
+
+size_t traza_volcar(traza_escribir_t escribir, void *ctx)
+{
+	traza.activa = 0;
+	traza_barrier();
+
+	const uint32_t fin = traza.pos;
+	const uint32_t ini = fin > TRAZA_LEN ? fin - TRAZA_LEN : 0;
+	size_t bytes = __cabecera(escribir, ctx, ini);
+
+	for (uint32_t i = ini; i != fin; ++i)
+		escribir(&traza.buf[i & (TRAZA_LEN - 1)], sizeof(struct traza_reg), ctx);
+	bytes += (size_t)(fin - ini) * sizeof(struct traza_reg);
+
+	traza_barrier();
+	traza.activa = 1;
+	return bytes;
+}
+
+size_t traza_drenar(traza_escribir_t escribir, void *ctx)
+{
+	const volatile uint32_t *pos = &traza.pos;
+	size_t n = 0;
+
+	if (!traza.cabecera) {
+		__cabecera(escribir, ctx, 0);
+		traza.cabecera = 1;
+	}
+
+	const uint32_t fin = *pos;
+
+	/* El escritor dio la vuelta: se salta lo sobrescrito */
+	if (fin - traza.leido > TRAZA_LEN) {
+		uint32_t perdidos = fin - TRAZA_LEN - traza.leido;
+		struct traza_reg r = {
+			.t = traza.buf[fin & (TRAZA_LEN - 1)].t,
+			.info = TRAZA_PERDIDOS |
+				(perdidos > 0xFFFF ? 0xFFFFU : perdidos) << 16,
+		};
+		escribir(&r, sizeof(r), ctx);
+		traza.leido = fin - TRAZA_LEN;
+		n++;
+	}
+
+	while (traza.leido != fin) {
+		struct traza_reg r = traza.buf[traza.leido & (TRAZA_LEN - 1)];
+
+		/* Sobrescrito mientras se copiaba: lo cuenta la próxima vez */
+		traza_barrier();
+		if (*pos - traza.leido > TRAZA_LEN)
+			break;
+
+		escribir(&r, sizeof(r), ctx);
+		traza.leido++;
+		n++;
+	}
+	return n;
+}
+
+#endif // TRAZA
@@ -0,0 +1,147 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ciclos.h"
+
+/*
+ * Traza de eventos del scheduler (TRAZA = 1).
+ *
+ * Las macros trace* del kernel (ver FreeRTOSConfig.h) escriben registros
+ * de 8 bytes en un búfer circular en RAM: marca de tiempo de ciclos.h y
+ * {evento, tarea, dato}. Cuando se llena se sobrescribe lo más viejo
+ * (registrador de vuelo): se puede dejar activada en producción.
+ *
+ *	TRAZA_ENTRA		tarea = la que entra (uxTCBNumber)
+ *	TRAZA_SALE		tarea = la que sale; dato = 1 si sigue lista
+ *				(expulsada), 0 si se bloquea
+ *	TRAZA_TICK		dato = xTickCount (16 bits bajos)
+ *	TRAZA_COLA_*		dato = 16 bits bajos de la dirección de la cola
+ *				(únicos en los 20 KB de RAM)
+ *	TRAZA_NOTIF_ISR		dato = tarea notificada desde una ISR
+ *	TRAZA_NOTIF_*, TRAZA_ESPERA	tarea que llama (ulTaskNotifyTake,
+ *				vTaskDelay*); dato = 0
+ *	TRAZA_PERDIDOS		dato = registros perdidos (saturado), ver
+ *				traza_drenar()
+ *
+ * Los eventos de cola y de notificación que no dicen la tarea (tarea =
+ * 0) son de la que está en marcha. traza_evento() debe llamarse con las
+ * interrupciones del kernel enmascaradas: escribir un registro es un
+ * incremento y dos escrituras, sin atómicos. Casi todos los puntos de
+ * traza ya corren así (secciones críticas, PendSV, SysTick); los de
+ * vTaskDelay*() sólo suspenden el scheduler y enmascaran ellos mismos
+ * (trazaEVENTO_TAREA en FreeRTOSConfig.h).
+ *
+ * Para sacarla: traza_volcar() (búfer entero, p. ej. por un puerto serie
+ * tras un fallo) o traza_drenar() (flujo continuo, lo usa el host con
+ * main_host -T). host/traza2json pasa cualquiera de los dos al formato
+ * JSON de Chrome (chrome://tracing, ui.perfetto.dev).
+ */
+
+/* Registros en el búfer: 2^8 = 256, 2 KB (2^10, 8 KB, sin el heap del
+ * kernel: MEMORIA_ESTATICA) */
+#ifndef TRAZA_LOG2
+#if MEMORIA_ESTATICA
+#define TRAZA_LOG2		10
+#else
+#define TRAZA_LOG2		8
+#endif
+#endif
+#define TRAZA_LEN		(1U << TRAZA_LOG2)
+
+#ifndef TRAZA_MAX_TAREAS
+#define TRAZA_MAX_TAREAS	8
+#endif
+
+enum traza_evento {
+	TRAZA_ENTRA = 1,
+	TRAZA_SALE,
+	TRAZA_TICK,
+	TRAZA_COLA_ENVIO,
+	TRAZA_COLA_RECEPCION,
+	TRAZA_COLA_BLOQUEO,
+	TRAZA_NOTIF_ISR,
+	TRAZA_NOTIF_BLOQUEO,
+	TRAZA_NOTIF_TOMA,
+	TRAZA_ESPERA,
+	TRAZA_PERDIDOS = 0xFF,
+};
+
+struct traza_reg {
+	uint32_t t;			// ciclos_leer()
+	uint32_t info;			// evento | tarea << 8 | dato << 16
+};
+
+struct traza_estado {
+	struct traza_reg buf[TRAZA_LEN];
+	uint32_t pos;			// Registros escritos (sin módulo)
+	uint32_t leido;			// Hasta dónde llegó traza_drenar()
+	volatile uint8_t activa;
+	uint8_t cabecera;		// traza_drenar() ya la escribió
+	void *tarea[TRAZA_MAX_TAREAS + 1];	// TaskHandle_t por uxTCBNumber
+};
+
+extern struct traza_estado traza;
+
+static inline void traza_evento(uint32_t ev, uint32_t tarea, uint32_t dato)
+{
+	if (!traza.activa)
+		return;
+
+	struct traza_reg *r = &traza.buf[traza.pos++ & (TRAZA_LEN - 1)];
+	r->t = ciclos_leer();
+	r->info = ev | tarea << 8 | dato << 16;
+}
+
+/* traceTASK_CREATE: recuerda el handle de cada tarea (para los nombres) */
+static inline void traza_creada(void *tarea, unsigned n)
+{
+	if (n <= TRAZA_MAX_TAREAS)
+		traza.tarea[n] = tarea;
+}
+
+/**
+ * @brief Arranca el contador de ciclos y la traza.
+ *
+ * Antes de vTaskStartScheduler().
+ */
+void traza_init(void);
+
+/*
+ * Formato de traza_volcar() y traza_drenar() (little-endian):
+ *
+ *	0	"TRZ", versión (1)
+ *	4	u32 frecuencia del reloj de las marcas de tiempo, Hz
+ *	8	u8 tareas (N), u8 TRAZA_LOG2, u16 0
+ *	12	u32 registros perdidos antes del primero
+ *	16	N x 16 bytes: u8 número (uxTCBNumber), nombre (15, con '\0')
+ *	16+16N	registros de 8 bytes (struct traza_reg) hasta el final
+ */
+#define TRAZA_VERSION		1
+
+/* Destino de los bytes: puerto serie, fichero... */
+typedef void (*traza_escribir_t)(const void *datos, size_t n, void *ctx);
+
+/**
+ * @brief Escribe la cabecera y todo el búfer, del registro más viejo al
+ *        más nuevo (desde una tarea).
+ *
+ * La traza se pausa mientras tanto: los eventos de ese intervalo se
+ * pierden.
+ * @return Bytes escritos.
+ */
+size_t traza_volcar(traza_escribir_t escribir, void *ctx);
+
+/**
+ * @brief Escribe los registros nuevos desde la llamada anterior (la
+ *        primera vez, precedidos de la cabecera).
+ *
+ * Siempre desde el mismo contexto. Si el búfer dio la vuelta antes de
+ * leerlos, escribe un registro TRAZA_PERDIDOS con los que faltan.
+ * @return Registros escritos.
+ */
+size_t traza_drenar(traza_escribir_t escribir, void *ctx);
+
+#endif // TRAZA_H